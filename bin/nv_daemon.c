@@ -0,0 +1,46 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include <nvif/client.h>
+#include <nvif/driver.h>
+#include <nvif/device.h>
+#include <nvif/class.h>
+
+#include "util.h"
+
+int
+main(int argc, char **argv)
+{
+	struct nvif_client client;
+	struct nvif_device device;
+	const char *path = NULL;
+	int ret, c;
+
+	while ((c = getopt(argc, argv, "s:"U_GETOPT)) != -1) {
+		switch (c) {
+		case 's':
+			path = optarg;
+			break;
+		default:
+			if (!u_option(c))
+				return 1;
+			break;
+		}
+	}
+
+	/* Hold the device open, so it's only initialised the once, rather
+	 * than by each "ipc" client that connects.
+	 */
+	ret = u_device("lib", argv[0], "error", true, true, ~0ULL,
+		       0x00000000, &client, &device);
+	if (ret)
+		return ret;
+
+	ret = nvos_ipc_serve(path);
+	fprintf(stderr, "nvos_ipc_serve failed, %d\n", ret);
+
+	nvif_device_fini(&device);
+	nvif_client_fini(&client);
+	return ret;
+}
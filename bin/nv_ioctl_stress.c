@@ -0,0 +1,309 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Hammers a single client from several threads through the nvif API, mixing
+ * the ioctls that only share the client (rd/wr, map/unmap, mthd, sclass and
+ * notify get/put) with ones that need it exclusively (new/del of devices and
+ * their children).  Every operation must succeed, and register writes made
+ * through one object must be seen through another's mapping of the same BAR.
+ *
+ * Runs against the null backend by default, whose BAR0 is plain memory, so
+ * it needs no hardware.  On real hardware (-b lib) registers are only read,
+ * and notify get/put is covered using vblank on the display, if there's one.
+ */
+#include <nvif/client.h>
+#include <nvif/class.h>
+#include <nvif/cl0080.h>
+#include <nvif/cl0046.h>
+#include <nvif/device.h>
+#include <nvif/disp.h>
+#include <nvif/event.h>
+#include <nvif/notify.h>
+
+#include "util.h"
+
+enum {
+	OP_RDWR,
+	OP_MAP,
+	OP_MTHD,
+	OP_NEW,
+	OP_SCLASS,
+	OP_NTFY,
+	OP_NR
+};
+
+static const char *op_name[OP_NR] = {
+	[OP_RDWR]   = "rd/wr",
+	[OP_MAP]    = "map/unmap",
+	[OP_MTHD]   = "mthd",
+	[OP_NEW]    = "new/del",
+	[OP_SCLASS] = "sclass",
+	[OP_NTFY]   = "ntfy get/put",
+};
+
+static struct nvif_client client;
+static struct nvif_device device;
+static struct nvif_disp disp;
+static u64 device_name;
+static bool scratch;
+
+struct worker {
+	pthread_t thread;
+	int id;
+	int nr;
+	struct nvif_device device;
+	struct nvif_notify notify;
+	u32 data;
+	int ok[OP_NR];
+	int fail[OP_NR];
+};
+
+static int
+stress_notify(struct nvif_notify *notify)
+{
+	return NVIF_NOTIFY_DROP;
+}
+
+static int
+stress_device(struct worker *w)
+{
+	return nvif_device_init(&client.object, 0x100 + w->id, NV_DEVICE,
+				&(struct nv_device_v0) {
+					.device = device_name,
+				}, sizeof(struct nv_device_v0), &w->device);
+}
+
+/* Each worker owns a dword of the null BAR, past anything nvkm touches. */
+static u32
+stress_addr(struct worker *w)
+{
+	return scratch ? 0x800000 + w->id * 4 : 0x000000;
+}
+
+static int
+stress_rdwr(struct worker *w)
+{
+	u32 addr = stress_addr(w);
+
+	if (scratch) {
+		nvif_wr32(&device.object, addr, ++w->data);
+		return nvif_rd32(&device.object, addr) == w->data ? 0 : -EIO;
+	}
+
+	return nvif_rd32(&device.object, addr) ==
+	       nvif_rd32(&device.object, addr) ? 0 : -EIO;
+}
+
+static int
+stress_map(struct worker *w)
+{
+	u32 addr = stress_addr(w);
+	int ret;
+
+	ret = nvif_object_map(&w->device.object, NULL, 0);
+	if (ret)
+		return ret;
+
+	if (scratch &&
+	    ioread32_native((u8 __iomem *)w->device.object.map.ptr + addr) !=
+	    w->data)
+		ret = -EIO;
+
+	nvif_object_unmap(&w->device.object);
+	return ret;
+}
+
+static int
+stress_mthd(struct worker *w)
+{
+	struct nv_device_info_v0 info = {};
+	int ret;
+
+	ret = nvif_object_mthd(&device.object, NV_DEVICE_V0_INFO,
+			       &info, sizeof(info));
+	if (ret == 0 && info.chipset != device.info.chipset)
+		ret = -EIO;
+	return ret;
+}
+
+static int
+stress_new(struct worker *w)
+{
+	struct nvif_object ctrl;
+	int ret;
+
+	/* Replace the worker's own device, and create a child under it. */
+	nvif_device_fini(&w->device);
+	ret = stress_device(w);
+	if (ret)
+		return ret;
+
+	ret = nvif_object_init(&w->device.object, 0x200 + w->id,
+			       NVIF_CLASS_CONTROL, NULL, 0, &ctrl);
+	nvif_object_fini(&ctrl);
+	return ret;
+}
+
+static int
+stress_sclass(struct worker *w)
+{
+	struct nvif_sclass *sclass;
+	int ret;
+
+	ret = nvif_object_sclass_get(&w->device.object, &sclass);
+	if (ret < 0)
+		return ret;
+
+	nvif_object_sclass_put(&sclass);
+	return ret ? 0 : -ENODEV;
+}
+
+static int
+stress_ntfy(struct worker *w)
+{
+	int ret;
+
+	ret = nvif_notify_get(&w->notify);
+	if (ret == 0)
+		ret = nvif_notify_put(&w->notify);
+	return ret;
+}
+
+static int (*const stress_op[OP_NR])(struct worker *) = {
+	[OP_RDWR]   = stress_rdwr,
+	[OP_MAP]    = stress_map,
+	[OP_MTHD]   = stress_mthd,
+	[OP_NEW]    = stress_new,
+	[OP_SCLASS] = stress_sclass,
+	[OP_NTFY]   = stress_ntfy,
+};
+
+static void *
+stress_worker(void *data)
+{
+	struct worker *w = data;
+	int i, op;
+
+	for (i = 0; i < w->nr; i++) {
+		/* Interleave differently per thread, so the ops overlap. */
+		op = (i + w->id) % OP_NR;
+		if (op == OP_NTFY && !disp.object.client)
+			continue;
+
+		if (stress_op[op](w) == 0)
+			w->ok[op]++;
+		else
+			w->fail[op]++;
+	}
+
+	return NULL;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct worker *worker;
+	int threads = 8, count = 100000;
+	int ok[OP_NR] = {}, fail[OP_NR] = {}, failed = 0;
+	bool hw;
+	int ret, c, i, j;
+
+	while ((c = getopt(argc, argv, "n:t:"U_GETOPT)) != -1) {
+		switch (c) {
+		case 'n': count = strtol(optarg, NULL, 0); break;
+		case 't': threads = strtol(optarg, NULL, 0); break;
+		default:
+			if (!u_option(c))
+				return 1;
+			break;
+		}
+	}
+
+	if (threads < 1 || threads > 0x100 ||
+	    !(worker = calloc(threads, sizeof(*worker))))
+		return 1;
+
+	hw = u_drv && strcmp(u_drv, "null");
+	ret = u_device("null", argv[0], "error", hw, true, hw ? ~0ULL : 0,
+		       0x00000000, &client, &device);
+	if (ret)
+		return ret;
+
+	device_name = u_device_name(&client, u_dev);
+	scratch = !hw;
+
+	if (nvif_disp_ctor(&device, 0, &disp))
+		printf("no display, notify get/put not covered\n");
+
+	for (i = 0; i < threads; i++) {
+		struct worker *w = &worker[i];
+
+		w->id = i;
+		w->nr = count;
+		ret = stress_device(w);
+		if (ret)
+			return 1;
+
+		if (disp.object.client) {
+			ret = nvif_notify_init(&disp.object, stress_notify,
+					       false, NV04_DISP_NTFY_VBLANK,
+					       &(struct nvif_notify_head_req_v0) {
+						.head = 0,
+					       },
+					       sizeof(struct nvif_notify_head_req_v0),
+					       sizeof(struct nvif_notify_head_rep_v0),
+					       &w->notify);
+			if (ret)
+				return 1;
+		}
+	}
+
+	for (i = 0; i < threads; i++) {
+		ret = pthread_create(&worker[i].thread, NULL,
+				     stress_worker, &worker[i]);
+		if (ret)
+			return 1;
+	}
+
+	for (i = 0; i < threads; i++) {
+		pthread_join(worker[i].thread, NULL);
+		for (j = 0; j < OP_NR; j++) {
+			ok[j] += worker[i].ok[j];
+			fail[j] += worker[i].fail[j];
+		}
+		if (disp.object.client)
+			nvif_notify_fini(&worker[i].notify);
+		nvif_device_fini(&worker[i].device);
+	}
+
+	nvif_disp_dtor(&disp);
+	nvif_device_fini(&device);
+	nvif_client_fini(&client);
+
+	for (j = 0; j < OP_NR; j++) {
+		printf("%-12s %8d ok, %d failed\n", op_name[j], ok[j], fail[j]);
+		failed += fail[j];
+	}
+
+	printf("%s\n", failed ? "FAIL" : "PASS");
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Replays L2 flush/invalidate requests through nvkm_ltc_flush() and
+ * nvkm_ltc_invalidate() against a model of the gf100 registers, and checks
+ * that coalescing kept the register-visible semantics: every request must
+ * be covered by a hardware operation that started after the request was
+ * made and completed before it returned, and a strictly sequential replay
+ * must issue exactly one operation per request.
+ */
+#include <nvif/os.h>
+
+#include <subdev/ltc/priv.h>
+
+#include <pthread.h>
+
+struct trace {
+	u32 addr;
+	u32 data;
+	u64 start;
+	u64 end;
+};
+
+static struct trace *trace;
+static int trace_nr;
+static int trace_max;
+static u64 clock_seq;
+static int delay = 100;
+
+static u64
+now(void)
+{
+	return __atomic_add_fetch(&clock_seq, 1, __ATOMIC_SEQ_CST);
+}
+
+/* Both ops run under ltc->lock, so appending to the trace needs no lock. */
+static void
+replay_op(u32 addr)
+{
+	struct trace *t;
+
+	BUG_ON(trace_nr >= trace_max);
+	t = &trace[trace_nr++];
+	t->addr = addr;
+	t->data = 0x00000001;
+	t->start = now();
+	usleep(delay);
+	t->end = now();
+}
+
+static void
+replay_invalidate(struct nvkm_ltc *ltc)
+{
+	replay_op(0x070004);
+}
+
+static void
+replay_flush(struct nvkm_ltc *ltc)
+{
+	replay_op(0x070010);
+}
+
+static const struct nvkm_ltc_func
+replay_ltc = {
+	.invalidate = replay_invalidate,
+	.flush = replay_flush,
+};
+
+struct request {
+	u32 addr;
+	u64 made;
+	u64 done;
+};
+
+struct worker {
+	pthread_t thread;
+	struct nvkm_ltc *ltc;
+	struct request *req;
+	int nr;
+};
+
+static void
+replay_request(struct nvkm_ltc *ltc, struct request *req)
+{
+	req->made = now();
+	if (req->addr == 0x070010)
+		nvkm_ltc_flush(ltc);
+	else
+		nvkm_ltc_invalidate(ltc);
+	req->done = now();
+}
+
+static void *
+replay_worker(void *data)
+{
+	struct worker *w = data;
+	int i;
+
+	for (i = 0; i < w->nr; i++)
+		replay_request(w->ltc, &w->req[i]);
+	return NULL;
+}
+
+static int
+replay_check(struct request *req, int nr)
+{
+	int fail = 0, i, j;
+
+	for (i = 0; i < nr; i++) {
+		for (j = 0; j < trace_nr; j++) {
+			if (trace[j].addr == req[i].addr &&
+			    trace[j].start > req[i].made &&
+			    trace[j].end < req[i].done)
+				break;
+		}
+
+		if (j == trace_nr) {
+			printf("request %d (%06x) made at %llu, returned at "
+			       "%llu, not covered by any operation\n", i,
+			       req[i].addr, req[i].made, req[i].done);
+			fail++;
+		}
+	}
+
+	return fail;
+}
+
+int
+main(int argc, char **argv)
+{
+	struct nvkm_ltc ltc = { .func = &replay_ltc };
+	struct worker *worker;
+	struct request *req;
+	int threads = 8, count = 1000;
+	int fail = 0, ret, c, i;
+
+	while ((c = getopt(argc, argv, "n:t:u:")) != -1) {
+		switch (c) {
+		case 'n': count = strtol(optarg, NULL, 0); break;
+		case 't': threads = strtol(optarg, NULL, 0); break;
+		case 'u': delay = strtol(optarg, NULL, 0); break;
+		default:
+			return 1;
+		}
+	}
+
+	if (count < 1 || threads < 1)
+		return 1;
+
+	trace_max = threads * count;
+	trace = calloc(trace_max, sizeof(*trace));
+	req = calloc(trace_max, sizeof(*req));
+	worker = calloc(threads, sizeof(*worker));
+	if (!trace || !req || !worker)
+		return 1;
+
+	for (i = 0; i < trace_max; i++)
+		req[i].addr = (i & 1) ? 0x070004 : 0x070010;
+	mutex_init(&ltc.lock);
+
+	/* Sequential: nothing to coalesce, so one operation per request. */
+	for (i = 0; i < count; i++)
+		replay_request(&ltc, &req[i]);
+
+	fail += replay_check(req, count);
+	if (trace_nr != count) {
+		printf("sequential: %d requests issued %d operations\n",
+		       count, trace_nr);
+		fail++;
+	}
+
+	printf("sequential: %d requests, %d operations\n", count, trace_nr);
+
+	/* Concurrent: requests may piggyback, but must still be covered. */
+	trace_nr = 0;
+	memset(&ltc.flush, 0x00, sizeof(ltc.flush));
+	memset(&ltc.invalidate, 0x00, sizeof(ltc.invalidate));
+
+	for (i = 0; i < threads; i++) {
+		worker[i].ltc = &ltc;
+		worker[i].req = &req[i * count];
+		worker[i].nr = count;
+		ret = pthread_create(&worker[i].thread, NULL,
+				     replay_worker, &worker[i]);
+		if (ret)
+			return 1;
+	}
+
+	for (i = 0; i < threads; i++)
+		pthread_join(worker[i].thread, NULL);
+
+	fail += replay_check(req, trace_max);
+	printf("concurrent: %d requests, %d operations, flush %llu issued "
+	       "%llu elided, invalidate %llu issued %llu elided\n",
+	       trace_max, trace_nr, ltc.flush.issued, ltc.flush.elided,
+	       ltc.invalidate.issued, ltc.invalidate.elided);
+
+	if (ltc.flush.issued + ltc.invalidate.issued != trace_nr ||
+	    ltc.flush.issued + ltc.flush.elided +
+	    ltc.invalidate.issued + ltc.invalidate.elided != trace_max) {
+		printf("counters don't match the replayed trace\n");
+		fail++;
+	}
+
+	printf("%s\n", fail ? "FAIL" : "PASS");
+	return fail ? 1 : 0;
+}
@@ -30,6 +30,25 @@ u_option(int c)
 	return true;
 }
 
+#ifdef CONFIG_NOUVEAU_DEBUG_MMIO
+static void
+u_mmio_print(void *priv, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vfprintf(priv, fmt, args);
+	va_end(args);
+}
+
+/* Report MMIO traffic on exit when NVKM_MMIO_PROFILE is set. */
+static void
+u_mmio_dump(void)
+{
+	nvkm_mmio_dump(u_mmio_print, stderr);
+}
+#endif
+
 static inline int
 u_client(const char *drv, const char *name, const char *dbg,
 	 bool detect, bool mmio, u64 subdev, struct nvif_client *client)
@@ -37,6 +56,10 @@ u_client(const char *drv, const char *name, const char *dbg,
 	os_device_detect = detect;
 	os_device_mmio = mmio;
 	os_device_subdev = subdev;
+#ifdef CONFIG_NOUVEAU_DEBUG_MMIO
+	if (getenv("NVKM_MMIO_PROFILE"))
+		atexit(u_mmio_dump);
+#endif
 	return nvif_driver_init(u_drv ? u_drv : drv, u_cfg,
 				u_dbg ? u_dbg : dbg, name, ~0ULL, client);
 }
@@ -501,7 +501,7 @@ nv50_head_create(struct drm_device *dev, int index)
 	drm_mode_crtc_set_gamma_size(crtc, 256);
 
 	if (head->func->olut_set) {
-		ret = nv50_lut_init(disp, &drm->client.mmu, &head->olut);
+		ret = nv50_lut_init(disp, &drm->client.pool, &head->olut);
 		if (ret)
 			goto out;
 	}
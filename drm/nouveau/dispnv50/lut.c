@@ -33,8 +33,8 @@ nv50_lut_load(struct nv50_lut *lut, int buffer, struct drm_property_blob *blob,
 	      void (*load)(struct drm_color_lut *, int, void __iomem *))
 {
 	struct drm_color_lut *in = blob ? blob->data : NULL;
-	void __iomem *mem = lut->mem[buffer].object.map.ptr;
-	const u32 addr = lut->mem[buffer].addr;
+	void __iomem *mem = lut->mem[buffer].ptr;
+	const u32 addr = lut->mem[buffer].mem->addr + lut->mem[buffer].offset;
 	int i;
 
 	if (!in) {
@@ -60,18 +60,17 @@ nv50_lut_fini(struct nv50_lut *lut)
 {
 	int i;
 	for (i = 0; i < ARRAY_SIZE(lut->mem); i++)
-		nvif_mem_fini(&lut->mem[i]);
+		nvif_mem_pool_put(&lut->mem[i]);
 }
 
 int
-nv50_lut_init(struct nv50_disp *disp, struct nvif_mmu *mmu,
+nv50_lut_init(struct nv50_disp *disp, struct nvif_mem_pool *pool,
 	      struct nv50_lut *lut)
 {
 	const u32 size = disp->disp->object.oclass < GF110_DISP ? 257 : 1025;
 	int i;
 	for (i = 0; i < ARRAY_SIZE(lut->mem); i++) {
-		int ret = nvif_mem_init_map(mmu, NVIF_MEM_VRAM, size * 8,
-					    &lut->mem[i]);
+		int ret = nvif_mem_pool_get(pool, size * 8, &lut->mem[i]);
 		if (ret)
 			return ret;
 	}
@@ -10,6 +10,22 @@ struct nvif_client {
 	u64 version;
 	u8 route;
 	bool super;
+
+	/* Objects mapped by nvif_object_rd/wr(), oldest first.  When
+	 * 'limit' is reached the oldest is unmapped to make room.  'mutex'
+	 * protects the list and counters, and is held across every access
+	 * through an automapped pointer so eviction can't pull a mapping
+	 * out from under another thread.
+	 */
+	struct {
+		struct mutex mutex;
+		struct list_head list;
+		u32 count;
+		u32 limit;
+		u32 mapped;
+		u32 evicted;
+		u32 failed;
+	} automap;
 };
 
 int  nvif_client_init(struct nvif_client *parent, const char *name, u64 device,
@@ -14,7 +14,16 @@ struct nvif_driver {
 	int (*ioctl)(void *priv, bool super, void *data, u32 size, void **hack);
 	void __iomem *(*map)(void *priv, u64 handle, u32 size);
 	void (*unmap)(void *priv, void __iomem *ptr, u32 size);
+	/* Called after a notify has been deleted, so that events for it the
+	 * driver still has queued are discarded rather than delivered.
+	 */
+	void (*ntfy_del)(void *priv, u64 token);
 	bool keep;
+
+	/* Number of nvif_object_rd/wr() ioctls after which an unmapped
+	 * object is mapped automatically, or 0 to never do so.
+	 */
+	u32 automap;
 };
 
 int nvif_driver_init(const char *drv, const char *cfg, const char *dbg,
@@ -22,6 +31,8 @@ int nvif_driver_init(const char *drv, const char *cfg, const char *dbg,
 
 extern const struct nvif_driver nvif_driver_nvkm;
 extern const struct nvif_driver nvif_driver_drm;
+extern const struct nvif_driver nvif_driver_ipc;
 extern const struct nvif_driver nvif_driver_lib;
+extern const struct nvif_driver nvif_driver_lib_ring;
 extern const struct nvif_driver nvif_driver_null;
 #endif
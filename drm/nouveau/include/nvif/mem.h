@@ -17,4 +17,42 @@ int nvif_mem_init(struct nvif_mmu *mmu, s32 oclass, u8 type, u8 page,
 void nvif_mem_fini(struct nvif_mem *);
 
 int nvif_mem_init_map(struct nvif_mmu *, u8 type, u64 size, struct nvif_mem *);
+
+/* Sub-allocator for small, CPU-mapped allocations.  Requests are rounded
+ * up to a power-of-two size class and carved out of NVIF_MEM_POOL_SLAB
+ * sized nvif_mem objects that stay mapped for their lifetime, while
+ * anything larger than NVIF_MEM_POOL_MAX gets a dedicated object.
+ */
+#define NVIF_MEM_POOL_SLAB  0x10000
+#define NVIF_MEM_POOL_MIN   0x00040
+#define NVIF_MEM_POOL_MAX   0x04000
+
+struct nvif_mem_pool {
+	struct nvif_mmu *mmu;
+	u8 type;
+	struct mutex mutex;
+	struct list_head slabs;
+
+	struct {
+		u64 slabs;   /* slab objects created */
+		u64 objects; /* dedicated objects created */
+		u64 allocs;  /* allocations served from slabs */
+		u64 used;    /* bytes handed out from slabs */
+		u64 size;    /* bytes backing live slabs */
+	} stat;
+};
+
+struct nvif_mem_sub {
+	struct nvif_mem_pool *pool;
+	struct nvif_mem_slab *slab; /* NULL for dedicated objects */
+	struct nvif_mem *mem;
+	u64 offset;
+	u64 size;
+	void __iomem *ptr;
+};
+
+void nvif_mem_pool_init(struct nvif_mmu *, u8 type, struct nvif_mem_pool *);
+void nvif_mem_pool_fini(struct nvif_mem_pool *);
+int  nvif_mem_pool_get(struct nvif_mem_pool *, u64 size, struct nvif_mem_sub *);
+void nvif_mem_pool_put(struct nvif_mem_sub *);
 #endif
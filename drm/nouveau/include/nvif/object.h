@@ -19,6 +19,13 @@ struct nvif_object {
 		void __iomem *ptr;
 		u64 size;
 	} map;
+
+	struct {
+		u32 access; /* rd/wr ioctls since last (un)mapped */
+		bool mapped;
+		bool unsupported;
+		struct list_head head;
+	} automap;
 };
 
 int  nvif_object_init(struct nvif_object *, u32 handle, s32 oclass, void *, u32,
@@ -19,6 +19,28 @@ struct nvkm_client {
 
 	struct list_head umem;
 	spinlock_t lock;
+
+	/* Taken shared by ioctls that neither change the object tree nor
+	 * rely on per-object serialisation (see nvkm_ioctl_v0[]), so they
+	 * can run concurrently on one client, and exclusive by the rest.
+	 */
+	struct rw_semaphore ioctl;
+
+	/* One for the object itself, plus one per nvkm_ioctl() in flight, so
+	 * a client that deletes itself isn't freed under ioctls still queued
+	 * on 'ioctl'.  Those find 'dead' set once they get the lock.
+	 */
+	refcount_t users;
+	bool dead;
+
+	/* Hints for nvkm_ioctl_new(), mapping a parent's object type and
+	 * the requested class to the sclass() index that last matched.
+	 */
+	struct {
+		const struct nvkm_object_func *func;
+		s32 oclass;
+		int index;
+	} sclass[16];
 };
 
 int  nvkm_client_new(const char *name, u64 device, const char *cfg,
@@ -256,6 +256,39 @@ struct nvkm_device *nvkm_device_find(u64 name);
 int nvkm_device_list(u64 *name, int size);
 
 /* privileged register interface accessor macros */
+#ifdef CONFIG_NOUVEAU_DEBUG_MMIO
+struct nvkm_mmio_site {
+	const char *file;
+	const char *func;
+	int line;
+	bool listed;
+	u64 rd, wr, mask, ns;
+	struct nvkm_mmio_site *next;
+};
+
+u32  nvkm_mmio_rd(const struct nvkm_device *, u32 addr, int size,
+		  struct nvkm_mmio_site *);
+void nvkm_mmio_wr(const struct nvkm_device *, u32 addr, int size, u32 data,
+		  struct nvkm_mmio_site *);
+u32  nvkm_mmio_mask(const struct nvkm_device *, u32 addr, u32 mask, u32 data,
+		    struct nvkm_mmio_site *);
+void nvkm_mmio_dump(void (*print)(void *, const char *, ...), void *);
+void nvkm_mmio_reset(void);
+
+#define NVKM_MMIO_SITE ({                                                      \
+	static struct nvkm_mmio_site _site = {                                 \
+		.file = __FILE__, .func = __func__, .line = __LINE__,          \
+	};                                                                     \
+	&_site;                                                                \
+})
+#define nvkm_rd08(d,a) ((u8)nvkm_mmio_rd((d), (a), 1, NVKM_MMIO_SITE))
+#define nvkm_rd16(d,a) ((u16)nvkm_mmio_rd((d), (a), 2, NVKM_MMIO_SITE))
+#define nvkm_rd32(d,a) nvkm_mmio_rd((d), (a), 4, NVKM_MMIO_SITE)
+#define nvkm_wr08(d,a,v) nvkm_mmio_wr((d), (a), 1, (u8)(v), NVKM_MMIO_SITE)
+#define nvkm_wr16(d,a,v) nvkm_mmio_wr((d), (a), 2, (u16)(v), NVKM_MMIO_SITE)
+#define nvkm_wr32(d,a,v) nvkm_mmio_wr((d), (a), 4, (v), NVKM_MMIO_SITE)
+#define nvkm_mask(d,a,m,v) nvkm_mmio_mask((d), (a), (m), (v), NVKM_MMIO_SITE)
+#else
 #define nvkm_rd08(d,a) ioread8((d)->pri + (a))
 #define nvkm_rd16(d,a) ioread16_native((d)->pri + (a))
 #define nvkm_rd32(d,a) ioread32_native((d)->pri + (a))
@@ -268,6 +301,7 @@ int nvkm_device_list(u64 *name, int size);
 	nvkm_wr32(_device, _addr, (_temp & ~(m)) | (v));                       \
 	_temp;                                                                 \
 })
+#endif
 
 void nvkm_device_del(struct nvkm_device **);
 
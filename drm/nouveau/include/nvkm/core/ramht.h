@@ -16,6 +16,13 @@ struct nvkm_ramht {
 	struct nvkm_gpuobj *gpuobj;
 	int size;
 	int bits;
+
+	int count;     /* live entries */
+	int probe_max; /* furthest any live entry sits from its hash slot */
+	u64 probes;    /* sum of live entries' probe distances */
+	int count_peak;
+	int probe_peak;
+
 	struct nvkm_ramht_data data[];
 };
 
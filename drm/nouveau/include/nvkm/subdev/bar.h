@@ -11,6 +11,17 @@ struct nvkm_bar {
 	spinlock_t lock;
 	bool bar2;
 
+	/* Each flush request bumps 'gen', and a flush that samples 'gen'
+	 * before hitting the hardware covers every request up to that
+	 * point, letting requests that raced with it complete for free.
+	 */
+	struct {
+		atomic_t gen;
+		u32 done;
+		u64 issued;
+		u64 elided;
+	} flush;
+
 	/* whether the BAR supports to be ioremapped WC or should be uncached */
 	bool iomap_uncached;
 };
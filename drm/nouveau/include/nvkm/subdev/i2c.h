@@ -162,14 +162,23 @@ nvkm_probe_i2c(struct i2c_adapter *adap, u8 addr)
 	return nvkm_rdi2cr(adap, addr, 0) >= 0;
 }
 
+/* Accesses larger than a single AUX transaction are split into 16-byte
+ * chunks, holding the channel for the whole burst.
+ */
 static inline int
 nvkm_rdaux(struct nvkm_i2c_aux *aux, u32 addr, u8 *data, u8 size)
 {
-	const u8 xfer = size;
 	int ret = nvkm_i2c_aux_acquire(aux);
 	if (ret == 0) {
-		ret = nvkm_i2c_aux_xfer(aux, true, 9, addr, data, &size);
-		WARN_ON(!ret && size != xfer);
+		do {
+			const u8 xfer = min_t(u8, size, 16);
+			u8 done = xfer;
+			ret = nvkm_i2c_aux_xfer(aux, true, 9, addr, data, &done);
+			WARN_ON(!ret && done != xfer);
+			addr += xfer;
+			data += xfer;
+			size -= xfer;
+		} while (ret == 0 && size);
 		nvkm_i2c_aux_release(aux);
 	}
 	return ret;
@@ -180,7 +189,13 @@ nvkm_wraux(struct nvkm_i2c_aux *aux, u32 addr, u8 *data, u8 size)
 {
 	int ret = nvkm_i2c_aux_acquire(aux);
 	if (ret == 0) {
-		ret = nvkm_i2c_aux_xfer(aux, true, 8, addr, data, &size);
+		do {
+			u8 xfer = min_t(u8, size, 16);
+			ret = nvkm_i2c_aux_xfer(aux, true, 8, addr, data, &xfer);
+			addr += xfer;
+			data += xfer;
+			size -= xfer;
+		} while (ret == 0 && size);
 		nvkm_i2c_aux_release(aux);
 	}
 	return ret;
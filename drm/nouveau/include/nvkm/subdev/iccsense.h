@@ -12,6 +12,20 @@ struct nvkm_iccsense {
 
 	u32 power_w_max;
 	u32 power_w_crit;
+
+	/* Sensors are swept at most once per max_age (or per conversion
+	 * period, if longer), concurrent readers share the last sample.
+	 */
+	struct mutex mutex;
+	u32 max_age; /* us */
+	u64 time;
+	int power;
+
+	struct {
+		u32 sweeps;
+		u32 cached;
+		u32 xfers;
+	} stat;
 };
 
 int gf100_iccsense_new(struct nvkm_device *, int index, struct nvkm_iccsense **);
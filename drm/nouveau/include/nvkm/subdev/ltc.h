@@ -6,6 +6,16 @@
 
 #define NVKM_LTC_MAX_ZBC_CNT 16
 
+/* Requests bump 'gen', and an operation that samples 'gen' before it
+ * hits the hardware covers every request made up to that point.
+ */
+struct nvkm_ltc_op {
+	atomic_t gen;
+	u32 done;
+	u64 issued;
+	u64 elided;
+};
+
 struct nvkm_ltc {
 	const struct nvkm_ltc_func *func;
 	struct nvkm_subdev subdev;
@@ -17,14 +27,31 @@ struct nvkm_ltc {
 	u32 tag_base;
 	struct nvkm_memory *tag_ram;
 
+	/* Freed comptags are only marked dirty, and are cleared either by
+	 * a background worker or, if reallocated first, on allocation.
+	 */
+	struct {
+		unsigned long *dirty;
+		struct work_struct work;
+		bool running; /* worker may touch hw, under subdev.mutex */
+		u64 sync;  /* allocations that had to clear inline */
+		u64 fast;  /* allocations served from already-clean tags */
+		u64 async; /* tags cleared by the background worker */
+	} cbc;
+
 	int zbc_min;
 	int zbc_max;
 	u32 zbc_color[NVKM_LTC_MAX_ZBC_CNT][4];
 	u32 zbc_depth[NVKM_LTC_MAX_ZBC_CNT];
 	u32 zbc_stencil[NVKM_LTC_MAX_ZBC_CNT];
+
+	struct mutex lock; /* serialises flush/invalidate, may sleep */
+	struct nvkm_ltc_op flush;
+	struct nvkm_ltc_op invalidate;
 };
 
 void nvkm_ltc_tags_clear(struct nvkm_device *, u32 first, u32 count);
+void nvkm_ltc_tags_free(struct nvkm_device *, u32 first, u32 count);
 
 int nvkm_ltc_zbc_color_get(struct nvkm_ltc *, int index, const u32[4]);
 int nvkm_ltc_zbc_depth_get(struct nvkm_ltc *, int index, const u32);
@@ -50,6 +50,7 @@ nouveau_abi16(struct drm_file *file_priv)
 			};
 
 			INIT_LIST_HEAD(&abi16->channels);
+			INIT_LIST_HEAD(&abi16->bolists);
 
 			/* allocate device object targeting client's default
 			 * device (ie. the one that belongs to the fd it
@@ -166,6 +167,9 @@ nouveau_abi16_fini(struct nouveau_abi16 *abi16)
 		nouveau_abi16_chan_fini(abi16, chan);
 	}
 
+	/* release buffer lists */
+	nouveau_gem_bolist_fini(abi16);
+
 	/* destroy the device object */
 	nvif_device_fini(&abi16->device);
 
@@ -32,6 +32,8 @@ struct nouveau_abi16 {
 	struct nvif_device device;
 	struct list_head channels;
 	u64 handles;
+	struct list_head bolists;
+	u32 bolist_id;
 };
 
 struct nouveau_abi16 *nouveau_abi16_get(struct drm_file *);
@@ -29,6 +29,7 @@
 
 #include <linux/dma-mapping.h>
 #include <linux/swiotlb.h>
+#include <linux/sizes.h>
 
 #include "nouveau_drv.h"
 #include "nouveau_dma.h"
@@ -139,6 +140,8 @@ nouveau_bo_del_ttm(struct ttm_buffer_object *bo)
 	if (unlikely(nvbo->gem.filp))
 		DRM_ERROR("bo %p still attached to GEM object\n", bo);
 	WARN_ON(nvbo->pin_refcnt > 0);
+	WARN_ON(!xa_empty(&nvbo->vma_xa));
+	xa_destroy(&nvbo->vma_xa);
 	nv10_bo_put_tile_region(dev, nvbo->tile, NULL);
 	kfree(nvbo);
 }
@@ -213,6 +216,7 @@ nouveau_bo_new(struct nouveau_cli *cli, u64 size, int align,
 	INIT_LIST_HEAD(&nvbo->head);
 	INIT_LIST_HEAD(&nvbo->entry);
 	INIT_LIST_HEAD(&nvbo->vma_list);
+	xa_init(&nvbo->vma_xa);
 	nvbo->bo.bdev = &drm->ttm.bdev;
 
 	/* This is confusing, and doesn't actually mean we want an uncached
@@ -718,26 +722,34 @@ nve0_bo_move_init(struct nouveau_channel *chan, u32 handle)
 }
 
 static int
-nve0_bo_move_copy(struct nouveau_channel *chan, struct ttm_buffer_object *bo,
-		  struct ttm_mem_reg *old_reg, struct ttm_mem_reg *new_reg)
+nve0_bo_move_pages(struct nouveau_channel *chan, u64 src_offset, u64 dst_offset,
+		   u32 page_count)
 {
-	struct nouveau_mem *mem = nouveau_mem(old_reg);
 	int ret = RING_SPACE(chan, 10);
 	if (ret == 0) {
 		BEGIN_NVC0(chan, NvSubCopy, 0x0400, 8);
-		OUT_RING  (chan, upper_32_bits(mem->vma[0].addr));
-		OUT_RING  (chan, lower_32_bits(mem->vma[0].addr));
-		OUT_RING  (chan, upper_32_bits(mem->vma[1].addr));
-		OUT_RING  (chan, lower_32_bits(mem->vma[1].addr));
+		OUT_RING  (chan, upper_32_bits(src_offset));
+		OUT_RING  (chan, lower_32_bits(src_offset));
+		OUT_RING  (chan, upper_32_bits(dst_offset));
+		OUT_RING  (chan, lower_32_bits(dst_offset));
 		OUT_RING  (chan, PAGE_SIZE);
 		OUT_RING  (chan, PAGE_SIZE);
 		OUT_RING  (chan, PAGE_SIZE);
-		OUT_RING  (chan, new_reg->num_pages);
+		OUT_RING  (chan, page_count);
 		BEGIN_IMC0(chan, NvSubCopy, 0x0300, 0x0386);
 	}
 	return ret;
 }
 
+static int
+nve0_bo_move_copy(struct nouveau_channel *chan, struct ttm_buffer_object *bo,
+		  struct ttm_mem_reg *old_reg, struct ttm_mem_reg *new_reg)
+{
+	struct nouveau_mem *mem = nouveau_mem(old_reg);
+	return nve0_bo_move_pages(chan, mem->vma[0].addr, mem->vma[1].addr,
+				  new_reg->num_pages);
+}
+
 static int
 nvc0_bo_move_init(struct nouveau_channel *chan, u32 handle)
 {
@@ -1090,6 +1102,75 @@ done:
 	return 0;
 }
 
+/* Moves of at least twice this many pages are split across copy engines. */
+#define NOUVEAU_BO_MOVE_SPLIT (SZ_4M >> PAGE_SHIFT)
+
+/* Hand all but the first chunk of the buffer to the extra copy engines,
+ * and have the TTM channel wait on each of them (on the GPU, via the
+ * usual fence sync) before copying the first chunk itself.  The fence
+ * emitted on the TTM channel afterwards then covers the whole move.
+ */
+static int
+nouveau_bo_move_split(struct nouveau_drm *drm, struct ttm_buffer_object *bo,
+		      bool intr, struct ttm_mem_reg *new_reg)
+{
+	struct nouveau_fence *fence[ARRAY_SIZE(drm->ttm.ce)] = {};
+	struct nouveau_mem *mem = nouveau_mem(&bo->mem);
+	struct nouveau_channel *chan = drm->ttm.chan;
+	u32 pages = new_reg->num_pages;
+	u32 nr = min_t(u32, drm->ttm.ce_nr + 1, pages / NOUVEAU_BO_MOVE_SPLIT);
+	u32 chunk = DIV_ROUND_UP(pages, nr);
+	int ret = 0, i;
+
+	for (i = 0; !ret && i < nr - 1; i++) {
+		struct nouveau_channel *ce = drm->ttm.ce[i].chan;
+		u32 start = chunk * (i + 1);
+		u32 count = min(chunk, pages - start);
+		u64 offset = (u64)start << PAGE_SHIFT;
+
+		ret = nouveau_fence_sync(nouveau_bo(bo), ce, true, intr);
+		if (ret)
+			break;
+
+		ce->dma.sleep = true;
+		ret = nve0_bo_move_pages(ce, mem->vma[0].addr + offset,
+					 mem->vma[1].addr + offset, count);
+		ce->dma.sleep = false;
+		if (ret)
+			break;
+
+		ret = nouveau_fence_new(ce, false, &fence[i]);
+		if (ret) {
+			/* The copy is already queued, with no fence to
+			 * wait on before the vmas go away.
+			 */
+			nouveau_channel_idle(ce);
+			break;
+		}
+
+		ret = nouveau_fence_sync_fence(&fence[i]->base, chan, intr);
+		drm->ttm.ce[i].bytes += (u64)count << PAGE_SHIFT;
+	}
+
+	if (ret == 0) {
+		chan->dma.sleep = true;
+		ret = nve0_bo_move_pages(chan, mem->vma[0].addr,
+					 mem->vma[1].addr, chunk);
+		chan->dma.sleep = false;
+	}
+
+	/* The temporary vmas go away as soon as we fail, make sure nothing
+	 * is still copying through them.
+	 */
+	for (i = 0; i < ARRAY_SIZE(fence); i++) {
+		if (ret && fence[i])
+			nouveau_fence_wait(fence[i], false, false);
+		nouveau_fence_unref(&fence[i]);
+	}
+
+	return ret;
+}
+
 static int
 nouveau_bo_move_m2mf(struct ttm_buffer_object *bo, int evict, bool intr,
 		     bool no_wait_gpu, struct ttm_mem_reg *new_reg)
@@ -1098,6 +1179,8 @@ nouveau_bo_move_m2mf(struct ttm_buffer_object *bo, int evict, bool intr,
 	struct nouveau_channel *chan = drm->ttm.chan;
 	struct nouveau_cli *cli = (void *)chan->user.client;
 	struct nouveau_fence *fence;
+	u64 size = (u64)new_reg->num_pages << PAGE_SHIFT;
+	bool split;
 	int ret;
 
 	/* create temporary vmas for the transfer and attach them to the
@@ -1111,9 +1194,17 @@ nouveau_bo_move_m2mf(struct ttm_buffer_object *bo, int evict, bool intr,
 	}
 
 	mutex_lock_nested(&cli->mutex, SINGLE_DEPTH_NESTING);
+	split = drm->ttm.ce_nr &&
+		new_reg->num_pages >= 2 * NOUVEAU_BO_MOVE_SPLIT;
 	ret = nouveau_fence_sync(nouveau_bo(bo), chan, true, intr);
 	if (ret == 0) {
-		ret = drm->ttm.move(chan, bo, &bo->mem, new_reg);
+		if (split) {
+			ret = nouveau_bo_move_split(drm, bo, intr, new_reg);
+		} else {
+			chan->dma.sleep = true;
+			ret = drm->ttm.move(chan, bo, &bo->mem, new_reg);
+			chan->dma.sleep = false;
+		}
 		if (ret == 0) {
 			ret = nouveau_fence_new(chan, false, &fence);
 			if (ret == 0) {
@@ -1125,6 +1216,16 @@ nouveau_bo_move_m2mf(struct ttm_buffer_object *bo, int evict, bool intr,
 			}
 		}
 	}
+
+	if (ret == 0) {
+		drm->ttm.stat.moves++;
+		drm->ttm.stat.bytes += size;
+		drm->ttm.stat.split += split;
+		if (evict) {
+			drm->ttm.stat.evicts++;
+			drm->ttm.stat.evict_bytes += size;
+		}
+	}
 	mutex_unlock(&cli->mutex);
 	return ret;
 }
@@ -1164,7 +1265,7 @@ nouveau_bo_move_init(struct nouveau_drm *drm)
 		{ "CRYPT", 0, 0x88b4, nv98_bo_move_exec, nv50_bo_move_init },
 	}, *mthd = _methods;
 	const char *name = "CPU";
-	int ret;
+	int ret, i;
 
 	do {
 		struct nouveau_channel *chan;
@@ -1194,7 +1295,36 @@ nouveau_bo_move_init(struct nouveau_drm *drm)
 		}
 	} while ((++mthd)->exec);
 
-	NV_INFO(drm, "MM: using %s for buffer copies\n", name);
+	/* Splitting a move is only implemented for the Kepler+ CE classes. */
+	if (drm->ttm.move == nve0_bo_move_copy && drm->ttm.chan == drm->cechan) {
+		for (i = 0; i < ARRAY_SIZE(drm->ttm.ce); i++) {
+			struct nouveau_channel *chan = drm->ttm.ce[i].chan;
+			struct nvif_object *copy = &drm->ttm.ce[i].copy;
+
+			if (!chan)
+				break;
+
+			ret = nvif_object_init(&chan->user,
+					       mthd->oclass | (mthd->engine << 16),
+					       mthd->oclass, NULL, 0, copy);
+			if (ret == 0) {
+				ret = mthd->init(chan, copy->handle);
+				if (ret)
+					nvif_object_fini(copy);
+			}
+
+			if (ret)
+				break;
+		}
+		drm->ttm.ce_nr = i;
+	}
+
+	if (drm->ttm.ce_nr) {
+		NV_INFO(drm, "MM: using %s for buffer copies, across %d "
+			     "engines\n", name, drm->ttm.ce_nr + 1);
+	} else {
+		NV_INFO(drm, "MM: using %s for buffer copies\n", name);
+	}
 }
 
 static int
@@ -1282,6 +1412,8 @@ nouveau_bo_move_ntfy(struct ttm_buffer_object *bo, bool evict,
 	if (bo->destroy != nouveau_bo_del_ttm)
 		return;
 
+	nvbo->move_gen++;
+
 	if (mem && new_reg->mem_type != TTM_PL_SYSTEM &&
 	    mem->mem.page == nvbo->page) {
 		list_for_each_entry(vma, &nvbo->vma_list, head) {
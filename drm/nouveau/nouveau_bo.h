@@ -2,6 +2,7 @@
 #ifndef __NOUVEAU_BO_H__
 #define __NOUVEAU_BO_H__
 
+#include <linux/xarray.h>
 #include <drm/drm_gem.h>
 
 struct nouveau_channel;
@@ -23,8 +24,10 @@ struct nouveau_bo {
 	struct list_head entry;
 	int pbbo_index;
 	bool validate_mapped;
+	u32 move_gen; /* bumped each time the bo moves */
 
 	struct list_head vma_list;
+	struct xarray vma_xa; /* indexed by nouveau_vmm.id */
 
 	unsigned contig:1;
 	unsigned page:5;
@@ -37,6 +37,15 @@ struct nouveau_channel {
 		int ib_max;
 		int ib_free;
 		int ib_put;
+		/* time spent waiting for ring space */
+		struct {
+			u64 waits;
+			u64 sleeps;
+			u64 ns;
+			u64 max_ns;
+		} stat;
+		/* set by callers that may sleep while waiting for space */
+		bool sleep;
 	} dma;
 	u32 user_get_hi;
 	u32 user_get;
@@ -535,9 +535,21 @@ nouveau_connector_detect(struct drm_connector *connector, bool force)
 	struct nouveau_encoder *nv_partner;
 	struct i2c_adapter *i2c;
 	int type;
-	int ret;
+	int ret, gen;
 	enum drm_connector_status conn_status = connector_status_disconnected;
 
+	/* Nothing can have changed on a HPD-capable connector if we haven't
+	 * been notified since the last probe, skip talking to the sink.
+	 * This applies to forced probes (ie. from userspace) too, anything
+	 * that could invalidate the cache bumps probe_gen.
+	 */
+	gen = atomic_read(&nv_connector->probe_gen);
+	if (connector->polled == DRM_CONNECTOR_POLL_HPD &&
+	    nv_connector->edid && nv_connector->edid_gen == gen) {
+		NV_DEBUG(drm, "using cached EDID for %s\n", connector->name);
+		return connector_status_connected;
+	}
+
 	/* Cleanup the previous EDID block. */
 	if (nv_connector->edid) {
 		drm_connector_update_edid_property(connector, NULL);
@@ -603,6 +615,7 @@ nouveau_connector_detect(struct drm_connector *connector, bool force)
 		nouveau_connector_set_encoder(connector, nv_encoder);
 		conn_status = connector_status_connected;
 		drm_dp_cec_set_edid(&nv_connector->aux, nv_connector->edid);
+		nv_connector->edid_gen = gen;
 		goto out;
 	}
 
@@ -735,6 +748,8 @@ nouveau_connector_force(struct drm_connector *connector)
 	} else
 		type = DCB_OUTPUT_ANY;
 
+	atomic_inc(&nv_connector->probe_gen);
+
 	nv_encoder = find_encoder(connector, type);
 	if (!nv_encoder) {
 		NV_ERROR(drm, "can't find encoder to force %s on!\n",
@@ -1130,6 +1145,8 @@ nouveau_connector_hotplug(struct nvif_notify *notify)
 	struct nouveau_encoder *nv_encoder;
 	int ret;
 
+	atomic_inc(&nv_connector->probe_gen);
+
 	ret = pm_runtime_get(drm->dev->dev);
 	if (ret == 0) {
 		/* We can't block here if there's a pending PM request
@@ -1265,6 +1282,7 @@ nouveau_connector_create(struct drm_device *dev,
 
 	connector = &nv_connector->base;
 	nv_connector->index = index;
+	atomic_set(&nv_connector->probe_gen, 1);
 
 	/* attempt to parse vbios connector type and hotplug gpio */
 	nv_connector->dcb = olddcb_conn(dev, index);
@@ -59,6 +59,12 @@ struct nouveau_connector {
 
 	struct nouveau_encoder *detected_encoder;
 	struct edid *edid;
+	/* EDID/DPCD from the last successful probe are reused by detect()
+	 * until an HPD/IRQ_HPD, forced state change or display re-init
+	 * bumps probe_gen.
+	 */
+	atomic_t probe_gen;
+	int edid_gen;
 	struct drm_display_mode *native_mode;
 #ifdef CONFIG_DRM_NOUVEAU_BACKLIGHT
 	struct nouveau_backlight *backlight;
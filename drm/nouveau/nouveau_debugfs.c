@@ -31,8 +31,10 @@
 #include <linux/debugfs.h>
 #include <nvif/class.h>
 #include <nvif/if0001.h>
+#include <core/device.h>
 #include "nouveau_debugfs.h"
 #include "nouveau_drv.h"
+#include "nouveau_chan.h"
 
 static int
 nouveau_debugfs_vbios_image(struct seq_file *m, void *data)
@@ -66,6 +68,117 @@ nouveau_debugfs_strap_peek(struct seq_file *m, void *data)
 	return 0;
 }
 
+static int
+nouveau_debugfs_ttm_moves(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = m->private;
+	struct nouveau_drm *drm = nouveau_drm(node->minor->dev);
+	int i;
+
+	mutex_lock(&drm->client.mutex);
+	seq_printf(m, "moves:       %llu\n", drm->ttm.stat.moves);
+	seq_printf(m, "split:       %llu\n", drm->ttm.stat.split);
+	seq_printf(m, "bytes:       %llu\n", drm->ttm.stat.bytes);
+	seq_printf(m, "evicts:      %llu\n", drm->ttm.stat.evicts);
+	seq_printf(m, "evict_bytes: %llu\n", drm->ttm.stat.evict_bytes);
+	for (i = 0; i < drm->ttm.ce_nr; i++)
+		seq_printf(m, "ce%d_bytes:   %llu\n", i + 1, drm->ttm.ce[i].bytes);
+	mutex_unlock(&drm->client.mutex);
+	return 0;
+}
+
+static void
+nouveau_debugfs_dma_stalls_chan(struct seq_file *m, const char *name,
+				struct nouveau_channel *chan)
+{
+	if (!chan)
+		return;
+
+	seq_printf(m, "%-8s %4d %10llu %10llu %14llu %12llu\n", name,
+		   chan->chid, chan->dma.stat.waits, chan->dma.stat.sleeps,
+		   chan->dma.stat.ns, chan->dma.stat.max_ns);
+}
+
+static int
+nouveau_debugfs_dma_stalls(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = m->private;
+	struct nouveau_drm *drm = nouveau_drm(node->minor->dev);
+	char name[8];
+	int i;
+
+	mutex_lock(&drm->client.mutex);
+	seq_printf(m, "%-8s %4s %10s %10s %14s %12s\n",
+		   "channel", "chid", "waits", "sleeps", "ns", "max_ns");
+	nouveau_debugfs_dma_stalls_chan(m, "kernel", drm->channel);
+	nouveau_debugfs_dma_stalls_chan(m, "ce", drm->cechan);
+	for (i = 0; i < drm->ttm.ce_nr; i++) {
+		snprintf(name, sizeof(name), "ce%d", i + 1);
+		nouveau_debugfs_dma_stalls_chan(m, name, drm->ttm.ce[i].chan);
+	}
+	mutex_unlock(&drm->client.mutex);
+	return 0;
+}
+
+static int
+nouveau_debugfs_mem_pool(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = m->private;
+	struct nouveau_drm *drm = nouveau_drm(node->minor->dev);
+	struct nvif_mem_pool *pool = &drm->client.pool;
+
+	mutex_lock(&pool->mutex);
+	seq_printf(m, "slabs:   %llu\n", pool->stat.slabs);
+	seq_printf(m, "objects: %llu\n", pool->stat.objects);
+	seq_printf(m, "allocs:  %llu\n", pool->stat.allocs);
+	seq_printf(m, "used:    %llu\n", pool->stat.used);
+	seq_printf(m, "size:    %llu\n", pool->stat.size);
+	mutex_unlock(&pool->mutex);
+	return 0;
+}
+
+#ifdef CONFIG_NOUVEAU_DEBUG_MMIO
+static void
+nouveau_debugfs_mmio_print(void *priv, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	seq_vprintf(priv, fmt, args);
+	va_end(args);
+}
+
+static int
+nouveau_debugfs_mmio(struct seq_file *m, void *data)
+{
+	nvkm_mmio_dump(nouveau_debugfs_mmio_print, m);
+	return 0;
+}
+
+/* Any write clears the counters, to profile from a known point. */
+static ssize_t
+nouveau_debugfs_mmio_reset(struct file *file, const char __user *ubuf,
+			   size_t len, loff_t *offp)
+{
+	nvkm_mmio_reset();
+	return len;
+}
+
+static int
+nouveau_debugfs_mmio_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, nouveau_debugfs_mmio, inode->i_private);
+}
+
+static const struct file_operations nouveau_mmio_fops = {
+	.owner = THIS_MODULE,
+	.open = nouveau_debugfs_mmio_open,
+	.read = seq_read,
+	.write = nouveau_debugfs_mmio_reset,
+	.release = single_release,
+};
+#endif
+
 static int
 nouveau_debugfs_pstate_get(struct seq_file *m, void *data)
 {
@@ -207,6 +320,9 @@ static const struct file_operations nouveau_pstate_fops = {
 static struct drm_info_list nouveau_debugfs_list[] = {
 	{ "vbios.rom",  nouveau_debugfs_vbios_image, 0, NULL },
 	{ "strap_peek", nouveau_debugfs_strap_peek, 0, NULL },
+	{ "ttm_moves", nouveau_debugfs_ttm_moves, 0, NULL },
+	{ "dma_stalls", nouveau_debugfs_dma_stalls, 0, NULL },
+	{ "mem_pool", nouveau_debugfs_mem_pool, 0, NULL },
 };
 #define NOUVEAU_DEBUGFS_ENTRIES ARRAY_SIZE(nouveau_debugfs_list)
 
@@ -215,6 +331,9 @@ static const struct nouveau_debugfs_files {
 	const struct file_operations *fops;
 } nouveau_debugfs_files[] = {
 	{"pstate", &nouveau_pstate_fops},
+#ifdef CONFIG_NOUVEAU_DEBUG_MMIO
+	{"mmio", &nouveau_mmio_fops},
+#endif
 };
 
 int
@@ -418,6 +418,8 @@ nouveau_display_init(struct drm_device *dev, bool resume, bool runtime)
 	drm_connector_list_iter_begin(dev, &conn_iter);
 	nouveau_for_each_non_mst_connector_iter(connector, &conn_iter) {
 		struct nouveau_connector *conn = nouveau_connector(connector);
+		/* Sinks may have changed while we weren't listening. */
+		atomic_inc(&conn->probe_gen);
 		nvif_notify_get(&conn->hpd);
 	}
 	drm_connector_list_iter_end(&conn_iter);
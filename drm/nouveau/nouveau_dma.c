@@ -26,6 +26,7 @@
 
 #include "nouveau_drv.h"
 #include "nouveau_dma.h"
+#include "nouveau_fence.h"
 #include "nouveau_vmm.h"
 
 #include <nvif/user.h>
@@ -43,6 +44,39 @@ OUT_RINGp(struct nouveau_channel *chan, const void *data, unsigned nr_dwords)
 	chan->dma.cur += nr_dwords;
 }
 
+/* GET hasn't moved since it was last read, so rather than hammering USERD,
+ * sleep until the GPU completes the oldest outstanding fence on the channel.
+ *
+ * Ring space is also claimed from atomic context (fbcon from printk) and
+ * under RCU (cross-channel fence sync), so sleeping is opt-in through
+ * chan->dma.sleep.  Otherwise, or if there's no fence to wait on, we fall
+ * back to polling.
+ */
+static int
+nouveau_dma_stall(struct nouveau_channel *chan, int *timeout)
+{
+	int ret;
+
+	if (chan->dma.sleep) {
+		ret = nouveau_fence_wait_oldest(chan);
+		if (ret != -ENOENT) {
+			if (ret)
+				return -EBUSY;
+			chan->dma.stat.sleeps++;
+			*timeout = 0;
+			return 0;
+		}
+	}
+
+	if ((++*timeout & 0xff) == 0) {
+		udelay(1);
+		if (*timeout > 100000)
+			return -EBUSY;
+	}
+
+	return 0;
+}
+
 /* Fetch and adjust GPU GET pointer
  *
  * Returns:
@@ -54,6 +88,7 @@ static inline int
 READ_GET(struct nouveau_channel *chan, uint64_t *prev_get, int *timeout)
 {
 	uint64_t val;
+	int ret;
 
 	val = nvif_rd32(&chan->user, chan->user_get);
         if (chan->user_get_hi)
@@ -66,12 +101,10 @@ READ_GET(struct nouveau_channel *chan, uint64_t *prev_get, int *timeout)
 	if (val != *prev_get) {
 		*prev_get = val;
 		*timeout = 0;
-	}
-
-	if ((++*timeout & 0xff) == 0) {
-		udelay(1);
-		if (*timeout > 100000)
-			return -EBUSY;
+	} else {
+		ret = nouveau_dma_stall(chan, timeout);
+		if (ret)
+			return ret;
 	}
 
 	if (val < chan->push.addr ||
@@ -108,24 +141,26 @@ nv50_dma_push(struct nouveau_channel *chan, u64 offset, int length)
 static int
 nv50_dma_push_wait(struct nouveau_channel *chan, int count)
 {
-	uint32_t cnt = 0, prev_get = 0;
+	uint32_t prev_get = 0;
+	int cnt = 0, ret;
 
 	while (chan->dma.ib_free < count) {
 		uint32_t get = nvif_rd32(&chan->user, 0x88);
-		if (get != prev_get) {
-			prev_get = get;
-			cnt = 0;
-		}
-
-		if ((++cnt & 0xff) == 0) {
-			DRM_UDELAY(1);
-			if (cnt > 100000)
-				return -EBUSY;
-		}
 
 		chan->dma.ib_free = get - chan->dma.ib_put;
 		if (chan->dma.ib_free <= 0)
 			chan->dma.ib_free += chan->dma.ib_max;
+		if (chan->dma.ib_free >= count)
+			break;
+
+		if (get != prev_get) {
+			prev_get = get;
+			cnt = 0;
+		} else {
+			ret = nouveau_dma_stall(chan, &cnt);
+			if (ret)
+				return ret;
+		}
 	}
 
 	return 0;
@@ -174,15 +209,12 @@ nv50_dma_wait(struct nouveau_channel *chan, int slots, int count)
 	return 0;
 }
 
-int
-nouveau_dma_wait(struct nouveau_channel *chan, int slots, int size)
+static int
+nv04_dma_wait(struct nouveau_channel *chan, int size)
 {
 	uint64_t prev_get = 0;
 	int cnt = 0, get;
 
-	if (chan->dma.ib_max)
-		return nv50_dma_wait(chan, slots, size);
-
 	while (chan->dma.free < size) {
 		get = READ_GET(chan, &prev_get, &cnt);
 		if (unlikely(get == -EBUSY))
@@ -257,3 +289,26 @@ nouveau_dma_wait(struct nouveau_channel *chan, int slots, int size)
 	return 0;
 }
 
+int
+nouveau_dma_wait(struct nouveau_channel *chan, int slots, int size)
+{
+	ktime_t time;
+	u64 ns;
+	int ret;
+
+	if (chan->dma.free >= size &&
+	    (!chan->dma.ib_max || chan->dma.ib_free > slots))
+		return 0;
+
+	time = ktime_get();
+	if (chan->dma.ib_max)
+		ret = nv50_dma_wait(chan, slots, size);
+	else
+		ret = nv04_dma_wait(chan, size);
+
+	ns = ktime_to_ns(ktime_sub(ktime_get(), time));
+	chan->dma.stat.waits++;
+	chan->dma.stat.ns += ns;
+	chan->dma.stat.max_ns = max(chan->dma.stat.max_ns, ns);
+	return ret;
+}
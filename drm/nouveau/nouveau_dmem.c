@@ -43,6 +43,7 @@
  */
 #define DMEM_CHUNK_SIZE (2UL << 20)
 #define DMEM_CHUNK_NPAGES (DMEM_CHUNK_SIZE >> PAGE_SHIFT)
+#define DMEM_FAULT_NPAGES 16UL
 
 struct nouveau_migrate;
 
@@ -96,6 +97,45 @@ struct nouveau_migrate {
 	unsigned long dma_nr;
 };
 
+/* Pages are queued here while both their source and destination follow
+ * on from the previous page, so that a physically contiguous run can be
+ * moved with a single copy.
+ */
+struct nouveau_dmem_run {
+	unsigned long i;
+	unsigned long npages;
+	u64 dst_addr;
+	u64 src_addr;
+};
+
+static bool
+nouveau_dmem_run_add(struct nouveau_dmem_run *run, unsigned long i,
+		     u64 dst_addr, u64 src_addr)
+{
+	u64 size = (u64)run->npages << PAGE_SHIFT;
+
+	if (run->npages && i == run->i + run->npages &&
+	    dst_addr == run->dst_addr + size &&
+	    src_addr == run->src_addr + size) {
+		run->npages++;
+		return true;
+	}
+
+	return false;
+}
+
+static inline bool
+nouveau_dmem_page(struct nouveau_drm *drm, struct page *page)
+{
+	if (!is_device_private_page(page))
+		return false;
+
+	if (drm->dmem->devmem != page->pgmap->data)
+		return false;
+
+	return true;
+}
+
 static void
 nouveau_dmem_free(struct hmm_devmem *devmem, struct page *page)
 {
@@ -123,6 +163,27 @@ nouveau_dmem_free(struct hmm_devmem *devmem, struct page *page)
 	spin_unlock(&chunk->lock);
 }
 
+static void
+nouveau_dmem_fault_copy(struct nouveau_drm *drm, struct nouveau_dmem_run *run,
+			unsigned long *dst_pfns)
+{
+	unsigned long i;
+	int ret;
+
+	if (!run->npages)
+		return;
+
+	ret = drm->dmem->migrate.copy_func(drm, run->npages,
+					   NOUVEAU_APER_HOST, run->dst_addr,
+					   NOUVEAU_APER_VRAM, run->src_addr);
+	if (ret) {
+		for (i = run->i; i < run->i + run->npages; i++) {
+			__free_page(migrate_pfn_to_page(dst_pfns[i]));
+			dst_pfns[i] = MIGRATE_PFN_ERROR;
+		}
+	}
+}
+
 static void
 nouveau_dmem_fault_alloc_and_copy(struct vm_area_struct *vma,
 				  const unsigned long *src_pfns,
@@ -134,10 +195,8 @@ nouveau_dmem_fault_alloc_and_copy(struct vm_area_struct *vma,
 	struct nouveau_dmem_fault *fault = private;
 	struct nouveau_drm *drm = fault->drm;
 	struct device *dev = drm->dev->dev;
+	struct nouveau_dmem_run run = {};
 	unsigned long addr, i, npages = 0;
-	nouveau_migrate_copy_t copy;
-	int ret;
-
 
 	/* First allocate new memory */
 	for (addr = start, i = 0; addr < end; addr += PAGE_SIZE, i++) {
@@ -148,6 +207,10 @@ nouveau_dmem_fault_alloc_and_copy(struct vm_area_struct *vma,
 		if (!spage || !(src_pfns[i] & MIGRATE_PFN_MIGRATE))
 			continue;
 
+		/* The fault window may cover pages that aren't ours. */
+		if (!nouveau_dmem_page(drm, spage))
+			continue;
+
 		dpage = hmm_vma_alloc_locked_page(vma, addr);
 		if (!dpage) {
 			dst_pfns[i] = MIGRATE_PFN_ERROR;
@@ -165,7 +228,6 @@ nouveau_dmem_fault_alloc_and_copy(struct vm_area_struct *vma,
 		goto error;
 
 	/* Copy things over */
-	copy = drm->dmem->migrate.copy_func;
 	for (addr = start, i = 0; addr < end; addr += PAGE_SIZE, i++) {
 		struct nouveau_dmem_chunk *chunk;
 		struct page *spage, *dpage;
@@ -176,11 +238,6 @@ nouveau_dmem_fault_alloc_and_copy(struct vm_area_struct *vma,
 			continue;
 
 		spage = migrate_pfn_to_page(src_pfns[i]);
-		if (!spage || !(src_pfns[i] & MIGRATE_PFN_MIGRATE)) {
-			dst_pfns[i] = MIGRATE_PFN_ERROR;
-			__free_page(dpage);
-			continue;
-		}
 
 		fault->dma[fault->npages] =
 			dma_map_page_attrs(dev, dpage, 0, PAGE_SIZE,
@@ -198,15 +255,16 @@ nouveau_dmem_fault_alloc_and_copy(struct vm_area_struct *vma,
 		src_addr = page_to_pfn(spage) - chunk->pfn_first;
 		src_addr = (src_addr << PAGE_SHIFT) + chunk->bo->bo.offset;
 
-		ret = copy(drm, 1, NOUVEAU_APER_HOST, dst_addr,
-				   NOUVEAU_APER_VRAM, src_addr);
-		if (ret) {
-			dst_pfns[i] = MIGRATE_PFN_ERROR;
-			__free_page(dpage);
-			continue;
+		if (!nouveau_dmem_run_add(&run, i, dst_addr, src_addr)) {
+			nouveau_dmem_fault_copy(drm, &run, dst_pfns);
+			run.i = i;
+			run.npages = 1;
+			run.dst_addr = dst_addr;
+			run.src_addr = src_addr;
 		}
 	}
 
+	nouveau_dmem_fault_copy(drm, &run, dst_pfns);
 	nouveau_fence_new(drm->dmem->migrate.chan, false, &fault->fence);
 
 	return;
@@ -268,24 +326,27 @@ nouveau_dmem_fault(struct hmm_devmem *devmem,
 		   pmd_t *pmdp)
 {
 	struct drm_device *drm_dev = dev_get_drvdata(devmem->device);
-	unsigned long src[1] = {0}, dst[1] = {0};
+	unsigned long src[DMEM_FAULT_NPAGES] = {0}, dst[DMEM_FAULT_NPAGES] = {0};
 	struct nouveau_dmem_fault fault = {0};
+	unsigned long start, end;
 	int ret;
 
-
-
-	/*
-	 * FIXME what we really want is to find some heuristic to migrate more
-	 * than just one page on CPU fault. When such fault happens it is very
-	 * likely that more surrounding page will CPU fault too.
+	/* A CPU fault on device memory is likely to be followed by faults
+	 * on the pages around it, so bring back the aligned neighbourhood
+	 * of the faulting page rather than just the one page, but no more,
+	 * as the GPU may still be using the rest.
 	 */
+	start = ALIGN_DOWN(addr, DMEM_FAULT_NPAGES << PAGE_SHIFT);
+	end = min(start + (DMEM_FAULT_NPAGES << PAGE_SHIFT), vma->vm_end);
+	start = max(start, vma->vm_start);
+
 	fault.drm = nouveau_drm(drm_dev);
-	ret = migrate_vma(&nouveau_dmem_fault_migrate_ops, vma, addr,
-			  addr + PAGE_SIZE, src, dst, &fault);
+	ret = migrate_vma(&nouveau_dmem_fault_migrate_ops, vma, start, end,
+			  src, dst, &fault);
 	if (ret)
 		return VM_FAULT_SIGBUS;
 
-	if (dst[0] == MIGRATE_PFN_ERROR)
+	if (dst[(addr - start) >> PAGE_SHIFT] == MIGRATE_PFN_ERROR)
 		return VM_FAULT_SIGBUS;
 
 	return 0;
@@ -336,7 +397,7 @@ nouveau_dmem_chunk_alloc(struct nouveau_drm *drm)
 out:
 	mutex_lock(&drm->dmem->mutex);
 	if (chunk->bo)
-		list_add(&chunk->list, &drm->dmem->chunk_empty);
+		list_add(&chunk->list, &drm->dmem->chunk_free);
 	else
 		list_add_tail(&chunk->list, &drm->dmem->chunk_empty);
 	mutex_unlock(&drm->dmem->mutex);
@@ -347,60 +408,75 @@ out:
 static struct nouveau_dmem_chunk *
 nouveau_dmem_chunk_first_free_locked(struct nouveau_drm *drm)
 {
-	struct nouveau_dmem_chunk *chunk;
+	struct nouveau_dmem_chunk *chunk, *temp;
 
-	chunk = list_first_entry_or_null(&drm->dmem->chunk_free,
-					 struct nouveau_dmem_chunk,
-					 list);
-	if (chunk)
-		return chunk;
+	list_for_each_entry_safe(chunk, temp, &drm->dmem->chunk_free, list) {
+		if (chunk->callocated < DMEM_CHUNK_NPAGES)
+			return chunk;
+		list_move_tail(&chunk->list, &drm->dmem->chunk_full);
+	}
 
-	chunk = list_first_entry_or_null(&drm->dmem->chunk_empty,
-					 struct nouveau_dmem_chunk,
-					 list);
-	if (chunk->bo)
-		return chunk;
+	/* Pages are freed without dmem->mutex, so full chunks don't get
+	 * moved back by nouveau_dmem_free(), check them before growing.
+	 */
+	list_for_each_entry_safe(chunk, temp, &drm->dmem->chunk_full, list) {
+		if (chunk->callocated < DMEM_CHUNK_NPAGES) {
+			list_move(&chunk->list, &drm->dmem->chunk_free);
+			return chunk;
+		}
+	}
 
 	return NULL;
 }
 
+/* Allocates npages device pages, in as few contiguous extents as the
+ * chunks allow.  Pages that couldn't be allocated are left as ~0UL.
+ */
 static int
 nouveau_dmem_pages_alloc(struct nouveau_drm *drm,
 			 unsigned long npages,
 			 unsigned long *pages)
 {
 	struct nouveau_dmem_chunk *chunk;
-	unsigned long c;
+	unsigned long c = 0;
 	int ret;
 
 	memset(pages, 0xff, npages * sizeof(*pages));
 
 	mutex_lock(&drm->dmem->mutex);
-	for (c = 0; c < npages;) {
-		unsigned long i;
+	while (c < npages) {
+		unsigned long i, n;
 
 		chunk = nouveau_dmem_chunk_first_free_locked(drm);
 		if (chunk == NULL) {
 			mutex_unlock(&drm->dmem->mutex);
 			ret = nouveau_dmem_chunk_alloc(drm);
+			mutex_lock(&drm->dmem->mutex);
 			if (ret) {
 				if (c)
 					break;
+				mutex_unlock(&drm->dmem->mutex);
 				return ret;
 			}
 			continue;
 		}
 
 		spin_lock(&chunk->lock);
-		i = find_first_zero_bit(chunk->bitmap, DMEM_CHUNK_NPAGES);
-		while (i < DMEM_CHUNK_NPAGES && c < npages) {
-			pages[c] = chunk->pfn_first + i;
-			set_bit(i, chunk->bitmap);
-			chunk->callocated++;
-			c++;
+		n = min(npages - c, DMEM_CHUNK_NPAGES);
+		while (c < npages && chunk->callocated < DMEM_CHUNK_NPAGES) {
+			i = bitmap_find_next_zero_area(chunk->bitmap,
+						       DMEM_CHUNK_NPAGES,
+						       0, n, 0);
+			if (i >= DMEM_CHUNK_NPAGES) {
+				n = max(n / 2, 1UL);
+				continue;
+			}
 
-			i = find_next_zero_bit(chunk->bitmap,
-					DMEM_CHUNK_NPAGES, i);
+			bitmap_set(chunk->bitmap, i, n);
+			chunk->callocated += n;
+			while (n--)
+				pages[c++] = chunk->pfn_first + i++;
+			n = min(npages - c, DMEM_CHUNK_NPAGES);
 		}
 		spin_unlock(&chunk->lock);
 	}
@@ -409,24 +485,6 @@ nouveau_dmem_pages_alloc(struct nouveau_drm *drm,
 	return 0;
 }
 
-static struct page *
-nouveau_dmem_page_alloc_locked(struct nouveau_drm *drm)
-{
-	unsigned long pfns[1];
-	struct page *page;
-	int ret;
-
-	/* FIXME stop all the miss-match API ... */
-	ret = nouveau_dmem_pages_alloc(drm, 1, pfns);
-	if (ret)
-		return NULL;
-
-	page = pfn_to_page(pfns[0]);
-	get_page(page);
-	lock_page(page);
-	return page;
-}
-
 static void
 nouveau_dmem_page_free_locked(struct nouveau_drm *drm, struct page *page)
 {
@@ -485,10 +543,11 @@ nouveau_dmem_fini(struct nouveau_drm *drm)
 
 	mutex_lock(&drm->dmem->mutex);
 
-	WARN_ON(!list_empty(&drm->dmem->chunk_free));
-	WARN_ON(!list_empty(&drm->dmem->chunk_full));
+	list_splice_init(&drm->dmem->chunk_free, &drm->dmem->chunk_empty);
+	list_splice_init(&drm->dmem->chunk_full, &drm->dmem->chunk_empty);
 
 	list_for_each_entry_safe (chunk, tmp, &drm->dmem->chunk_empty, list) {
+		WARN_ON(chunk->callocated);
 		if (chunk->bo) {
 			nouveau_bo_unpin(chunk->bo);
 			nouveau_bo_ref(NULL, &chunk->bo);
@@ -644,6 +703,28 @@ nouveau_dmem_init(struct nouveau_drm *drm)
 	NV_INFO(drm, "DMEM: registered %ldMB of device memory\n", size >> 20);
 }
 
+static void
+nouveau_dmem_migrate_copy(struct nouveau_drm *drm, struct nouveau_dmem_run *run,
+			  unsigned long *dst_pfns)
+{
+	unsigned long i;
+	int ret;
+
+	if (!run->npages)
+		return;
+
+	ret = drm->dmem->migrate.copy_func(drm, run->npages,
+					   NOUVEAU_APER_VRAM, run->dst_addr,
+					   NOUVEAU_APER_HOST, run->src_addr);
+	if (ret) {
+		for (i = run->i; i < run->i + run->npages; i++) {
+			nouveau_dmem_page_free_locked(drm,
+				migrate_pfn_to_page(dst_pfns[i]));
+			dst_pfns[i] = 0;
+		}
+	}
+}
+
 static void
 nouveau_dmem_migrate_alloc_and_copy(struct vm_area_struct *vma,
 				    const unsigned long *src_pfns,
@@ -655,31 +736,51 @@ nouveau_dmem_migrate_alloc_and_copy(struct vm_area_struct *vma,
 	struct nouveau_migrate *migrate = private;
 	struct nouveau_drm *drm = migrate->drm;
 	struct device *dev = drm->dev->dev;
-	unsigned long addr, i, npages = 0;
-	nouveau_migrate_copy_t copy;
-	int ret;
+	struct nouveau_dmem_run run = {};
+	unsigned long addr, i, c, *pfns, npages = 0;
 
-	/* First allocate new memory */
+	/* First allocate new memory, all at once so that it comes from
+	 * as few contiguous extents as possible.
+	 */
 	for (addr = start, i = 0; addr < end; addr += PAGE_SIZE, i++) {
-		struct page *dpage, *spage;
-
 		dst_pfns[i] = 0;
-		spage = migrate_pfn_to_page(src_pfns[i]);
-		if (!spage || !(src_pfns[i] & MIGRATE_PFN_MIGRATE))
+		if (migrate_pfn_to_page(src_pfns[i]) &&
+		    (src_pfns[i] & MIGRATE_PFN_MIGRATE))
+			npages++;
+	}
+
+	if (!npages)
+		return;
+
+	pfns = kmalloc_array(npages, sizeof(*pfns), GFP_KERNEL);
+	if (!pfns)
+		return;
+
+	if (nouveau_dmem_pages_alloc(drm, npages, pfns)) {
+		kfree(pfns);
+		return;
+	}
+
+	for (addr = start, i = 0, c = 0; addr < end; addr += PAGE_SIZE, i++) {
+		struct page *dpage;
+
+		if (!migrate_pfn_to_page(src_pfns[i]) ||
+		    !(src_pfns[i] & MIGRATE_PFN_MIGRATE))
 			continue;
 
-		dpage = nouveau_dmem_page_alloc_locked(drm);
-		if (!dpage)
+		if (pfns[c] == ~0UL) {
+			c++;
 			continue;
+		}
 
+		dpage = pfn_to_page(pfns[c++]);
+		get_page(dpage);
+		lock_page(dpage);
 		dst_pfns[i] = migrate_pfn(page_to_pfn(dpage)) |
 			      MIGRATE_PFN_LOCKED |
 			      MIGRATE_PFN_DEVICE;
-		npages++;
 	}
-
-	if (!npages)
-		return;
+	kfree(pfns);
 
 	/* Allocate storage for DMA addresses, so we can unmap later. */
 	migrate->dma = kmalloc(sizeof(*migrate->dma) * npages, GFP_KERNEL);
@@ -687,7 +788,6 @@ nouveau_dmem_migrate_alloc_and_copy(struct vm_area_struct *vma,
 		goto error;
 
 	/* Copy things over */
-	copy = drm->dmem->migrate.copy_func;
 	for (addr = start, i = 0; addr < end; addr += PAGE_SIZE, i++) {
 		struct nouveau_dmem_chunk *chunk;
 		struct page *spage, *dpage;
@@ -720,15 +820,16 @@ nouveau_dmem_migrate_alloc_and_copy(struct vm_area_struct *vma,
 
 		src_addr = migrate->dma[migrate->dma_nr++];
 
-		ret = copy(drm, 1, NOUVEAU_APER_VRAM, dst_addr,
-				   NOUVEAU_APER_HOST, src_addr);
-		if (ret) {
-			nouveau_dmem_page_free_locked(drm, dpage);
-			dst_pfns[i] = 0;
-			continue;
+		if (!nouveau_dmem_run_add(&run, i, dst_addr, src_addr)) {
+			nouveau_dmem_migrate_copy(drm, &run, dst_pfns);
+			run.i = i;
+			run.npages = 1;
+			run.dst_addr = dst_addr;
+			run.src_addr = src_addr;
 		}
 	}
 
+	nouveau_dmem_migrate_copy(drm, &run, dst_pfns);
 	nouveau_fence_new(drm->dmem->migrate.chan, false, &migrate->fence);
 
 	return;
@@ -774,6 +875,7 @@ void nouveau_dmem_migrate_finalize_and_map(struct vm_area_struct *vma,
 			       PAGE_SIZE, PCI_DMA_BIDIRECTIONAL);
 	}
 	kfree(migrate->dma);
+	migrate->dma_nr = 0;
 
 	/*
 	 * FIXME optimization: update GPU page table to point to newly
@@ -814,7 +916,7 @@ nouveau_dmem_migrate_vma(struct nouveau_drm *drm,
 	for (i = 0; i < npages; i += c) {
 		unsigned long next;
 
-		c = min(SG_MAX_SINGLE_ALLOC, npages);
+		c = min(SG_MAX_SINGLE_ALLOC, npages - i);
 		next = start + (c << PAGE_SHIFT);
 		ret = migrate_vma(&nouveau_dmem_migrate_ops, vma, start,
 				  next, src_pfns, dst_pfns, &migrate);
@@ -829,18 +931,6 @@ out:
 	return ret;
 }
 
-static inline bool
-nouveau_dmem_page(struct nouveau_drm *drm, struct page *page)
-{
-	if (!is_device_private_page(page))
-		return false;
-
-	if (drm->dmem->devmem != page->pgmap->data)
-		return false;
-
-	return true;
-}
-
 void
 nouveau_dmem_convert_pfn(struct nouveau_drm *drm,
 			 struct hmm_range *range)
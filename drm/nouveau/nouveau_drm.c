@@ -176,6 +176,7 @@ nouveau_cli_fini(struct nouveau_cli *cli)
 	usif_client_fini(cli);
 	nouveau_vmm_fini(&cli->svm);
 	nouveau_vmm_fini(&cli->vmm);
+	nvif_mem_pool_fini(&cli->pool);
 	nvif_mmu_fini(&cli->mmu);
 	nvif_device_fini(&cli->device);
 	mutex_lock(&cli->drm->master.lock);
@@ -221,6 +222,7 @@ nouveau_cli_init(struct nouveau_drm *drm, const char *sname,
 	INIT_WORK(&cli->work, nouveau_cli_work);
 	INIT_LIST_HEAD(&cli->worker);
 	mutex_init(&cli->lock);
+	nvif_mem_pool_init(&cli->mmu, NVIF_MEM_VRAM, &cli->pool);
 
 	if (cli == &drm->master) {
 		ret = nvif_driver_init(NULL, nouveau_config, nouveau_debug,
@@ -287,6 +289,15 @@ done:
 static void
 nouveau_accel_ce_fini(struct nouveau_drm *drm)
 {
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(drm->ttm.ce); i++) {
+		nouveau_channel_idle(drm->ttm.ce[i].chan);
+		nvif_object_fini(&drm->ttm.ce[i].copy);
+		nouveau_channel_del(&drm->ttm.ce[i].chan);
+	}
+	drm->ttm.ce_nr = 0;
+
 	nouveau_channel_idle(drm->cechan);
 	nvif_object_fini(&drm->ttm.copy);
 	nouveau_channel_del(&drm->cechan);
@@ -302,9 +313,27 @@ nouveau_accel_ce_init(struct nouveau_drm *drm)
 	 * engine, to use for TTM buffer moves.
 	 */
 	if (device->info.family >= NV_DEVICE_INFO_V0_KEPLER) {
-		ret = nouveau_channel_new(drm, device,
-					  nvif_fifo_runlist_ce(device), 0,
-					  true, &drm->cechan);
+		u64 runm = nvif_fifo_runlist_ce(device);
+		int i;
+
+		ret = nouveau_channel_new(drm, device, runm, 0, true,
+					  &drm->cechan);
+
+		/* The channel above lands on the first of the CE runlists,
+		 * grab a channel on each of the others too, so that large
+		 * buffer moves can be spread across several engines.
+		 */
+		runm &= runm - 1;
+		for (i = 0; !ret && runm && i < ARRAY_SIZE(drm->ttm.ce); i++) {
+			int tmp = nouveau_channel_new(drm, device, runm, 0, true,
+						      &drm->ttm.ce[i].chan);
+			if (tmp) {
+				NV_DEBUG(drm, "no extra ce channel %d, %d\n",
+					 i, tmp);
+				break;
+			}
+			runm &= runm - 1;
+		}
 	} else
 	if (device->info.chipset >= 0xa3 &&
 	    device->info.chipset != 0xaa &&
@@ -742,7 +771,7 @@ static int
 nouveau_do_suspend(struct drm_device *dev, bool runtime)
 {
 	struct nouveau_drm *drm = nouveau_drm(dev);
-	int ret;
+	int ret, i;
 
 	nouveau_svm_suspend(drm);
 	nouveau_dmem_suspend(drm);
@@ -761,6 +790,12 @@ nouveau_do_suspend(struct drm_device *dev, bool runtime)
 	ttm_bo_evict_mm(&drm->ttm.bdev, TTM_PL_VRAM);
 
 	NV_DEBUG(drm, "waiting for kernel channels to go idle...\n");
+	for (i = 0; i < drm->ttm.ce_nr; i++) {
+		ret = nouveau_channel_idle(drm->ttm.ce[i].chan);
+		if (ret)
+			goto fail_display;
+	}
+
 	if (drm->cechan) {
 		ret = nouveau_channel_idle(drm->cechan);
 		if (ret)
@@ -1060,6 +1095,7 @@ nouveau_ioctls[] = {
 	DRM_IOCTL_DEF_DRV(NOUVEAU_GEM_CPU_PREP, nouveau_gem_ioctl_cpu_prep, DRM_AUTH|DRM_RENDER_ALLOW),
 	DRM_IOCTL_DEF_DRV(NOUVEAU_GEM_CPU_FINI, nouveau_gem_ioctl_cpu_fini, DRM_AUTH|DRM_RENDER_ALLOW),
 	DRM_IOCTL_DEF_DRV(NOUVEAU_GEM_INFO, nouveau_gem_ioctl_info, DRM_AUTH|DRM_RENDER_ALLOW),
+	DRM_IOCTL_DEF_DRV(NOUVEAU_GEM_BOLIST, nouveau_gem_ioctl_bolist, DRM_AUTH|DRM_RENDER_ALLOW),
 };
 
 long
@@ -43,6 +43,7 @@
 #include <nvif/client.h>
 #include <nvif/device.h>
 #include <nvif/ioctl.h>
+#include <nvif/mem.h>
 #include <nvif/mmu.h>
 #include <nvif/vmm.h>
 
@@ -93,6 +94,7 @@ struct nouveau_cli {
 
 	struct nvif_device device;
 	struct nvif_mmu mmu;
+	struct nvif_mem_pool pool; /* small mapped VRAM allocations */
 	struct nouveau_vmm vmm;
 	struct nouveau_vmm svm;
 	const struct nvif_mclass *mem;
@@ -100,7 +102,8 @@ struct nouveau_cli {
 	struct list_head head;
 	void *abi16;
 	struct list_head objects;
-	struct list_head notifys;
+	/* indexed by handle, which nvkm allocates from its own notify[32] */
+	struct usif_notify *notifys[32];
 	char name[32];
 
 	struct work_struct work;
@@ -152,6 +155,20 @@ struct nouveau_drm {
 			    struct ttm_mem_reg *, struct ttm_mem_reg *);
 		struct nouveau_channel *chan;
 		struct nvif_object copy;
+		/* Further copy engines that large moves are split across. */
+		struct {
+			struct nouveau_channel *chan;
+			struct nvif_object copy;
+			u64 bytes;
+		} ce[3];
+		int ce_nr;
+		struct {
+			u64 moves;
+			u64 evicts;
+			u64 split;
+			u64 bytes;
+			u64 evict_bytes;
+		} stat;
 		int mtrr;
 		int type_vram;
 		int type_host[2];
@@ -40,6 +40,7 @@
 
 static const struct dma_fence_ops nouveau_fence_ops_uevent;
 static const struct dma_fence_ops nouveau_fence_ops_legacy;
+static bool nouveau_fence_is_signaled(struct dma_fence *);
 
 static inline struct nouveau_fence *
 from_fence(struct dma_fence *fence)
@@ -157,7 +158,7 @@ nouveau_fence_wait_uevent_handler(struct nvif_notify *notify)
 
 		fence = list_entry(fctx->pending.next, typeof(*fence), head);
 		chan = rcu_dereference_protected(fence->channel, lockdep_is_held(&fctx->lock));
-		if (nouveau_fence_update(fence->channel, fctx))
+		if (nouveau_fence_update(chan, fctx))
 			ret = NVIF_NOTIFY_DROP;
 	}
 	spin_unlock_irqrestore(&fctx->lock, flags);
@@ -244,6 +245,14 @@ nouveau_fence_done(struct nouveau_fence *fence)
 		if (test_bit(DMA_FENCE_FLAG_SIGNALED_BIT, &fence->base.flags))
 			return true;
 
+		/* Polling an incomplete fence is common (busy waits, resv
+		 * checks), and shouldn't contend with the interrupt handler
+		 * for fctx->lock, so only take it once there's something to
+		 * signal.
+		 */
+		if (!nouveau_fence_is_signaled(&fence->base))
+			return false;
+
 		spin_lock_irqsave(&fctx->lock, flags);
 		chan = rcu_dereference_protected(fence->channel, lockdep_is_held(&fctx->lock));
 		if (chan && nouveau_fence_update(chan, fctx))
@@ -288,25 +297,46 @@ nouveau_fence_wait_legacy(struct dma_fence *f, bool intr, long wait)
 	return timeout - t;
 }
 
+/* Spin for a short while, as a non-lazy wait is usually for something
+ * that's about to complete, then back off to sleeping so that a long
+ * wait doesn't keep a CPU busy.
+ */
+#define NOUVEAU_FENCE_SPIN_US 20
+
 static int
 nouveau_fence_wait_busy(struct nouveau_fence *fence, bool intr)
 {
+	ktime_t spin = ktime_add_us(ktime_get(), NOUVEAU_FENCE_SPIN_US);
+	unsigned long sleep_time = NSEC_PER_USEC;
 	int ret = 0;
 
 	while (!nouveau_fence_done(fence)) {
+		ktime_t kt;
+
 		if (time_after_eq(jiffies, fence->timeout)) {
 			ret = -EBUSY;
 			break;
 		}
 
-		__set_current_state(intr ?
-				    TASK_INTERRUPTIBLE :
-				    TASK_UNINTERRUPTIBLE);
-
 		if (intr && signal_pending(current)) {
 			ret = -ERESTARTSYS;
 			break;
 		}
+
+		if (ktime_before(ktime_get(), spin)) {
+			cpu_relax();
+			continue;
+		}
+
+		__set_current_state(intr ?
+				    TASK_INTERRUPTIBLE :
+				    TASK_UNINTERRUPTIBLE);
+
+		kt = sleep_time;
+		schedule_hrtimeout(&kt, HRTIMER_MODE_REL);
+		sleep_time *= 2;
+		if (sleep_time > NSEC_PER_MSEC)
+			sleep_time = NSEC_PER_MSEC;
 	}
 
 	__set_current_state(TASK_RUNNING);
@@ -330,14 +360,68 @@ nouveau_fence_wait(struct nouveau_fence *fence, bool lazy, bool intr)
 		return 0;
 }
 
+/* Sleep until the oldest fence still pending on chan has signalled, which
+ * guarantees the GPU has consumed the ring up to that point.  Returns
+ * -ENOENT if there's nothing pending to wait on.
+ */
 int
-nouveau_fence_sync(struct nouveau_bo *nvbo, struct nouveau_channel *chan, bool exclusive, bool intr)
+nouveau_fence_wait_oldest(struct nouveau_channel *chan)
+{
+	struct nouveau_fence_chan *fctx = chan->fence;
+	struct nouveau_fence *fence = NULL;
+	int ret;
+
+	if (!fctx)
+		return -ENOENT;
+
+	spin_lock_irq(&fctx->lock);
+	if (!list_empty(&fctx->pending)) {
+		fence = list_first_entry(&fctx->pending, typeof(*fence), head);
+		dma_fence_get(&fence->base);
+	}
+	spin_unlock_irq(&fctx->lock);
+	if (!fence)
+		return -ENOENT;
+
+	ret = nouveau_fence_wait(fence, true, false);
+	dma_fence_put(&fence->base);
+	return ret;
+}
+
+/* Make chan wait for fence, on the GPU if it's one of ours. */
+int
+nouveau_fence_sync_fence(struct dma_fence *fence, struct nouveau_channel *chan,
+			 bool intr)
 {
 	struct nouveau_fence_chan *fctx = chan->fence;
+	struct nouveau_channel *prev = NULL;
+	bool must_wait = true;
+	struct nouveau_fence *f;
+
+	/* Shared fences are frequently long done, skip the semaphore. */
+	if (dma_fence_is_signaled(fence))
+		return 0;
+
+	f = nouveau_local_fence(fence, chan->drm);
+	if (f) {
+		rcu_read_lock();
+		prev = rcu_dereference(f->channel);
+		if (prev && (prev == chan || fctx->sync(f, prev, chan) == 0))
+			must_wait = false;
+		rcu_read_unlock();
+	}
+
+	if (must_wait)
+		return dma_fence_wait(fence, intr);
+	return 0;
+}
+
+int
+nouveau_fence_sync(struct nouveau_bo *nvbo, struct nouveau_channel *chan, bool exclusive, bool intr)
+{
 	struct dma_fence *fence;
 	struct reservation_object *resv = nvbo->bo.resv;
 	struct reservation_object_list *fobj;
-	struct nouveau_fence *f;
 	int ret = 0, i;
 
 	if (!exclusive) {
@@ -350,46 +434,16 @@ nouveau_fence_sync(struct nouveau_bo *nvbo, struct nouveau_channel *chan, bool e
 	fobj = reservation_object_get_list(resv);
 	fence = reservation_object_get_excl(resv);
 
-	if (fence && (!exclusive || !fobj || !fobj->shared_count)) {
-		struct nouveau_channel *prev = NULL;
-		bool must_wait = true;
-
-		f = nouveau_local_fence(fence, chan->drm);
-		if (f) {
-			rcu_read_lock();
-			prev = rcu_dereference(f->channel);
-			if (prev && (prev == chan || fctx->sync(f, prev, chan) == 0))
-				must_wait = false;
-			rcu_read_unlock();
-		}
-
-		if (must_wait)
-			ret = dma_fence_wait(fence, intr);
-
-		return ret;
-	}
+	if (fence && (!exclusive || !fobj || !fobj->shared_count))
+		return nouveau_fence_sync_fence(fence, chan, intr);
 
 	if (!exclusive || !fobj)
 		return ret;
 
 	for (i = 0; i < fobj->shared_count && !ret; ++i) {
-		struct nouveau_channel *prev = NULL;
-		bool must_wait = true;
-
 		fence = rcu_dereference_protected(fobj->shared[i],
 						reservation_object_held(resv));
-
-		f = nouveau_local_fence(fence, chan->drm);
-		if (f) {
-			rcu_read_lock();
-			prev = rcu_dereference(f->channel);
-			if (prev && (prev == chan || fctx->sync(f, prev, chan) == 0))
-				must_wait = false;
-			rcu_read_unlock();
-		}
-
-		if (must_wait)
-			ret = dma_fence_wait(fence, intr);
+		ret = nouveau_fence_sync_fence(fence, chan, intr);
 	}
 
 	return ret;
@@ -61,20 +61,14 @@ nouveau_gem_object_del(struct drm_gem_object *gem)
 	pm_runtime_put_autosuspend(dev);
 }
 
-int
-nouveau_gem_object_open(struct drm_gem_object *gem, struct drm_file *file_priv)
+static int
+nouveau_gem_object_vma_get(struct nouveau_bo *nvbo, struct nouveau_vmm *vmm,
+			   struct nouveau_vma **pvma)
 {
-	struct nouveau_cli *cli = nouveau_cli(file_priv);
-	struct nouveau_bo *nvbo = nouveau_gem_object(gem);
 	struct nouveau_drm *drm = nouveau_bdev(nvbo->bo.bdev);
 	struct device *dev = drm->dev->dev;
-	struct nouveau_vmm *vmm = cli->svm.cli ? &cli->svm : &cli->vmm;
-	struct nouveau_vma *vma;
 	int ret;
 
-	if (vmm->vmm.object.oclass < NVIF_CLASS_VMM_NV50)
-		return 0;
-
 	ret = ttm_bo_reserve(&nvbo->bo, false, false, NULL);
 	if (ret)
 		return ret;
@@ -83,7 +77,7 @@ nouveau_gem_object_open(struct drm_gem_object *gem, struct drm_file *file_priv)
 	if (ret < 0 && ret != -EACCES)
 		goto out;
 
-	ret = nouveau_vma_new(nvbo, vmm, &vma);
+	ret = nouveau_vma_new(nvbo, vmm, pvma);
 	pm_runtime_mark_last_busy(dev);
 	pm_runtime_put_autosuspend(dev);
 out:
@@ -91,6 +85,20 @@ out:
 	return ret;
 }
 
+int
+nouveau_gem_object_open(struct drm_gem_object *gem, struct drm_file *file_priv)
+{
+	struct nouveau_cli *cli = nouveau_cli(file_priv);
+	struct nouveau_bo *nvbo = nouveau_gem_object(gem);
+	struct nouveau_vmm *vmm = cli->svm.cli ? &cli->svm : &cli->vmm;
+	struct nouveau_vma *vma;
+
+	if (vmm->vmm.object.oclass < NVIF_CLASS_VMM_NV50)
+		return 0;
+
+	return nouveau_gem_object_vma_get(nvbo, vmm, &vma);
+}
+
 struct nouveau_gem_object_unmap {
 	struct nouveau_cli_work work;
 	struct nouveau_vma *vma;
@@ -136,20 +144,14 @@ nouveau_gem_object_unmap(struct nouveau_bo *nvbo, struct nouveau_vma *vma)
 	nouveau_cli_work_queue(vma->vmm->cli, fence, &work->work);
 }
 
-void
-nouveau_gem_object_close(struct drm_gem_object *gem, struct drm_file *file_priv)
+static void
+nouveau_gem_object_vma_put(struct nouveau_bo *nvbo, struct nouveau_vmm *vmm)
 {
-	struct nouveau_cli *cli = nouveau_cli(file_priv);
-	struct nouveau_bo *nvbo = nouveau_gem_object(gem);
 	struct nouveau_drm *drm = nouveau_bdev(nvbo->bo.bdev);
 	struct device *dev = drm->dev->dev;
-	struct nouveau_vmm *vmm = cli->svm.cli ? &cli->svm : & cli->vmm;
 	struct nouveau_vma *vma;
 	int ret;
 
-	if (vmm->vmm.object.oclass < NVIF_CLASS_VMM_NV50)
-		return;
-
 	ret = ttm_bo_reserve(&nvbo->bo, false, false, NULL);
 	if (ret)
 		return;
@@ -168,6 +170,19 @@ nouveau_gem_object_close(struct drm_gem_object *gem, struct drm_file *file_priv)
 	ttm_bo_unreserve(&nvbo->bo);
 }
 
+void
+nouveau_gem_object_close(struct drm_gem_object *gem, struct drm_file *file_priv)
+{
+	struct nouveau_cli *cli = nouveau_cli(file_priv);
+	struct nouveau_bo *nvbo = nouveau_gem_object(gem);
+	struct nouveau_vmm *vmm = cli->svm.cli ? &cli->svm : & cli->vmm;
+
+	if (vmm->vmm.object.oclass < NVIF_CLASS_VMM_NV50)
+		return;
+
+	nouveau_gem_object_vma_put(nvbo, vmm);
+}
+
 int
 nouveau_gem_new(struct nouveau_cli *cli, u64 size, int align, uint32_t domain,
 		uint32_t tile_mode, uint32_t tile_flags,
@@ -323,6 +338,23 @@ struct validate_op {
 	struct ww_acquire_ctx ticket;
 };
 
+/* A validation list registered by the client for reuse across pushbufs.
+ * Handles are resolved, and a vma reference taken, once at creation, and
+ * each bo's placement is only revalidated after it has moved.
+ */
+struct nouveau_gem_bolist {
+	struct list_head head;
+	u32 id;
+	u32 nr_buffers;
+	struct nouveau_vmm *vmm;
+	struct drm_nouveau_gem_pushbuf_bo *pbbo; /* user_priv is the vma */
+	struct nouveau_gem_bolist_bo {
+		struct nouveau_bo *nvbo;
+		u32 move_gen;
+		bool valid;
+	} *bo;
+};
+
 static void
 validate_fini_no_ticket(struct validate_op *op, struct nouveau_channel *chan,
 			struct nouveau_fence *fence,
@@ -371,7 +403,8 @@ validate_fini(struct validate_op *op, struct nouveau_channel *chan,
 static int
 validate_init(struct nouveau_channel *chan, struct drm_file *file_priv,
 	      struct drm_nouveau_gem_pushbuf_bo *pbbo,
-	      int nr_buffers, struct validate_op *op)
+	      int nr_buffers, struct nouveau_gem_bolist *bolist,
+	      struct validate_op *op)
 {
 	struct nouveau_cli *cli = nouveau_cli(file_priv);
 	int trycnt = 0;
@@ -393,11 +426,17 @@ retry:
 		struct drm_gem_object *gem;
 		struct nouveau_bo *nvbo;
 
-		gem = drm_gem_object_lookup(file_priv, b->handle);
-		if (!gem) {
-			NV_PRINTK(err, cli, "Unknown handle 0x%08x\n", b->handle);
-			ret = -ENOENT;
-			break;
+		if (bolist) {
+			gem = &bolist->bo[i].nvbo->gem;
+			drm_gem_object_get(gem);
+		} else {
+			gem = drm_gem_object_lookup(file_priv, b->handle);
+			if (!gem) {
+				NV_PRINTK(err, cli, "Unknown handle 0x%08x\n",
+					  b->handle);
+				ret = -ENOENT;
+				break;
+			}
 		}
 		nvbo = nouveau_gem_object(gem);
 		if (nvbo == res_bo) {
@@ -433,6 +472,9 @@ retry:
 			}
 		}
 
+		if (bolist) {
+			/* user_priv already holds the list's own vma. */
+		} else
 		if (chan->vmm->vmm.object.oclass >= NVIF_CLASS_VMM_NV50) {
 			struct nouveau_vmm *vmm = chan->vmm;
 			struct nouveau_vma *vma = nouveau_vma_find(nvbo, vmm);
@@ -479,10 +521,30 @@ retry:
 
 }
 
+/* Whether a bo can be used as-is by a submission without relocations. */
+static bool
+validate_resident(struct nouveau_bo *nvbo, struct drm_nouveau_gem_pushbuf_bo *b)
+{
+	struct nouveau_vma *vma = (void *)(unsigned long)b->user_priv;
+
+	if (!vma->mem)
+		return false;
+
+	switch (nvbo->bo.mem.mem_type) {
+	case TTM_PL_VRAM:
+		return b->valid_domains & NOUVEAU_GEM_DOMAIN_VRAM;
+	case TTM_PL_TT:
+		return b->valid_domains & NOUVEAU_GEM_DOMAIN_GART;
+	default:
+		return false;
+	}
+}
+
 static int
 validate_list(struct nouveau_channel *chan, struct nouveau_cli *cli,
 	      struct list_head *list, struct drm_nouveau_gem_pushbuf_bo *pbbo,
-	      uint64_t user_pbbo_ptr)
+	      uint64_t user_pbbo_ptr, struct nouveau_gem_bolist *bolist,
+	      bool no_reloc)
 {
 	struct nouveau_drm *drm = chan->drm;
 	struct drm_nouveau_gem_pushbuf_bo __user *upbbo =
@@ -492,6 +554,15 @@ validate_list(struct nouveau_channel *chan, struct nouveau_cli *cli,
 
 	list_for_each_entry(nvbo, list, entry) {
 		struct drm_nouveau_gem_pushbuf_bo *b = &pbbo[nvbo->pbbo_index];
+		struct nouveau_gem_bolist_bo *lbo =
+			bolist ? &bolist->bo[nvbo->pbbo_index] : NULL;
+
+		/* Placement still satisfies what the list last asked for. */
+		if (lbo && lbo->valid && lbo->move_gen == nvbo->move_gen)
+			goto sync;
+
+		if (no_reloc && validate_resident(nvbo, b))
+			goto sync;
 
 		ret = nouveau_gem_set_domain(&nvbo->gem, b->read_domains,
 					     b->write_domains,
@@ -508,6 +579,12 @@ validate_list(struct nouveau_channel *chan, struct nouveau_cli *cli,
 			return ret;
 		}
 
+		if (lbo) {
+			lbo->move_gen = nvbo->move_gen;
+			lbo->valid = true;
+		}
+
+sync:
 		ret = nouveau_fence_sync(nvbo, chan, !!b->write_domains, true);
 		if (unlikely(ret)) {
 			if (ret != -ERESTARTSYS)
@@ -545,6 +622,7 @@ nouveau_gem_pushbuf_validate(struct nouveau_channel *chan,
 			     struct drm_file *file_priv,
 			     struct drm_nouveau_gem_pushbuf_bo *pbbo,
 			     uint64_t user_buffers, int nr_buffers,
+			     struct nouveau_gem_bolist *bolist, bool no_reloc,
 			     struct validate_op *op, int *apply_relocs)
 {
 	struct nouveau_cli *cli = nouveau_cli(file_priv);
@@ -555,14 +633,15 @@ nouveau_gem_pushbuf_validate(struct nouveau_channel *chan,
 	if (nr_buffers == 0)
 		return 0;
 
-	ret = validate_init(chan, file_priv, pbbo, nr_buffers, op);
+	ret = validate_init(chan, file_priv, pbbo, nr_buffers, bolist, op);
 	if (unlikely(ret)) {
 		if (ret != -ERESTARTSYS)
 			NV_PRINTK(err, cli, "validate_init\n");
 		return ret;
 	}
 
-	ret = validate_list(chan, cli, &op->list, pbbo, user_buffers);
+	ret = validate_list(chan, cli, &op->list, pbbo, user_buffers, bolist,
+			    no_reloc);
 	if (unlikely(ret < 0)) {
 		if (ret != -ERESTARTSYS)
 			NV_PRINTK(err, cli, "validating bo list\n");
@@ -604,6 +683,7 @@ nouveau_gem_pushbuf_reloc_apply(struct nouveau_cli *cli,
 				struct drm_nouveau_gem_pushbuf *req,
 				struct drm_nouveau_gem_pushbuf_bo *bo)
 {
+	DECLARE_BITMAP(ready, NOUVEAU_GEM_MAX_BUFFERS);
 	struct drm_nouveau_gem_pushbuf_reloc *reloc = NULL;
 	int ret = 0;
 	unsigned i;
@@ -612,16 +692,19 @@ nouveau_gem_pushbuf_reloc_apply(struct nouveau_cli *cli,
 	if (IS_ERR(reloc))
 		return PTR_ERR(reloc);
 
+	/* Check every relocation, and map and idle each bo that will be
+	 * patched, once per bo rather than once per relocation.
+	 */
+	bitmap_zero(ready, NOUVEAU_GEM_MAX_BUFFERS);
 	for (i = 0; i < req->nr_relocs; i++) {
 		struct drm_nouveau_gem_pushbuf_reloc *r = &reloc[i];
 		struct drm_nouveau_gem_pushbuf_bo *b;
 		struct nouveau_bo *nvbo;
-		uint32_t data;
 
 		if (unlikely(r->bo_index >= req->nr_buffers)) {
 			NV_PRINTK(err, cli, "reloc bo index invalid\n");
 			ret = -EINVAL;
-			break;
+			goto out;
 		}
 
 		b = &bo[r->bo_index];
@@ -631,7 +714,7 @@ nouveau_gem_pushbuf_reloc_apply(struct nouveau_cli *cli,
 		if (unlikely(r->reloc_bo_index >= req->nr_buffers)) {
 			NV_PRINTK(err, cli, "reloc container bo index invalid\n");
 			ret = -EINVAL;
-			break;
+			goto out;
 		}
 		nvbo = (void *)(unsigned long)bo[r->reloc_bo_index].user_priv;
 
@@ -639,19 +722,42 @@ nouveau_gem_pushbuf_reloc_apply(struct nouveau_cli *cli,
 			     nvbo->bo.mem.num_pages << PAGE_SHIFT)) {
 			NV_PRINTK(err, cli, "reloc outside of bo\n");
 			ret = -EINVAL;
-			break;
+			goto out;
 		}
 
+		if (test_and_set_bit(r->reloc_bo_index, ready))
+			continue;
+
 		if (!nvbo->kmap.virtual) {
 			ret = ttm_bo_kmap(&nvbo->bo, 0, nvbo->bo.mem.num_pages,
 					  &nvbo->kmap);
 			if (ret) {
 				NV_PRINTK(err, cli, "failed kmap for reloc\n");
-				break;
+				goto out;
 			}
 			nvbo->validate_mapped = true;
 		}
 
+		ret = ttm_bo_wait(&nvbo->bo, false, false);
+		if (ret) {
+			NV_PRINTK(err, cli, "reloc wait_idle failed: %d\n", ret);
+			goto out;
+		}
+	}
+
+	/* Patch, in the order given, as later relocations may overwrite
+	 * earlier ones.
+	 */
+	for (i = 0; i < req->nr_relocs; i++) {
+		struct drm_nouveau_gem_pushbuf_reloc *r = &reloc[i];
+		struct drm_nouveau_gem_pushbuf_bo *b = &bo[r->bo_index];
+		struct nouveau_bo *nvbo;
+		uint32_t data;
+
+		if (b->presumed.valid)
+			continue;
+		nvbo = (void *)(unsigned long)bo[r->reloc_bo_index].user_priv;
+
 		if (r->flags & NOUVEAU_GEM_RELOC_LOW)
 			data = b->presumed.offset + r->data;
 		else
@@ -667,17 +773,175 @@ nouveau_gem_pushbuf_reloc_apply(struct nouveau_cli *cli,
 				data |= r->vor;
 		}
 
-		ret = ttm_bo_wait(&nvbo->bo, false, false);
+		nouveau_bo_wr32(nvbo, r->reloc_bo_offset >> 2, data);
+	}
+
+out:
+	u_free(reloc);
+	return ret;
+}
+
+static struct nouveau_gem_bolist *
+nouveau_gem_bolist_find(struct nouveau_abi16 *abi16, u32 id)
+{
+	struct nouveau_gem_bolist *bolist;
+
+	list_for_each_entry(bolist, &abi16->bolists, head) {
+		if (bolist->id == id)
+			return bolist;
+	}
+
+	return NULL;
+}
+
+static void
+nouveau_gem_bolist_del(struct nouveau_gem_bolist *bolist)
+{
+	struct nouveau_bo *nvbo;
+	int i;
+
+	for (i = 0; i < bolist->nr_buffers; i++) {
+		nvbo = bolist->bo[i].nvbo;
+		nouveau_gem_object_vma_put(nvbo, bolist->vmm);
+		drm_gem_object_put_unlocked(&nvbo->gem);
+	}
+
+	list_del(&bolist->head);
+	kvfree(bolist->bo);
+	u_free(bolist->pbbo);
+	kfree(bolist);
+}
+
+static int
+nouveau_gem_bolist_new(struct nouveau_abi16 *abi16, struct drm_file *file_priv,
+		       struct drm_nouveau_gem_bolist *req)
+{
+	struct nouveau_cli *cli = nouveau_cli(file_priv);
+	struct nouveau_vmm *vmm = cli->svm.cli ? &cli->svm : &cli->vmm;
+	struct nouveau_gem_bolist *bolist;
+	struct drm_gem_object *gem;
+	struct nouveau_vma *vma;
+	int ret = 0, i;
+
+	/* Without a per-client VM, submission still needs relocations. */
+	if (vmm->vmm.object.oclass < NVIF_CLASS_VMM_NV50)
+		return -ENODEV;
+
+	if (!req->nr_buffers || req->nr_buffers > NOUVEAU_GEM_MAX_BUFFERS)
+		return -EINVAL;
+
+	if (!(bolist = kzalloc(sizeof(*bolist), GFP_KERNEL)))
+		return -ENOMEM;
+	INIT_LIST_HEAD(&bolist->head);
+	bolist->vmm = vmm;
+
+	bolist->pbbo = u_memcpya(req->buffers, req->nr_buffers,
+				 sizeof(*bolist->pbbo));
+	if (IS_ERR(bolist->pbbo)) {
+		ret = PTR_ERR(bolist->pbbo);
+		kfree(bolist);
+		return ret;
+	}
+
+	bolist->bo = kvcalloc(req->nr_buffers, sizeof(*bolist->bo),
+			      GFP_KERNEL);
+	if (!bolist->bo) {
+		u_free(bolist->pbbo);
+		kfree(bolist);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < req->nr_buffers; i++) {
+		struct drm_nouveau_gem_pushbuf_bo *b = &bolist->pbbo[i];
+		int j;
+
+		gem = drm_gem_object_lookup(file_priv, b->handle);
+		if (!gem) {
+			NV_PRINTK(err, cli, "Unknown handle 0x%08x\n", b->handle);
+			ret = -ENOENT;
+			break;
+		}
+
+		/* validate_init() would reject every submit using the list. */
+		for (j = 0; j < i; j++) {
+			if (bolist->bo[j].nvbo == nouveau_gem_object(gem)) {
+				NV_PRINTK(err, cli, "multiple instances of buffer "
+					  "%d on buffer list\n", b->handle);
+				ret = -EINVAL;
+				break;
+			}
+		}
+
 		if (ret) {
-			NV_PRINTK(err, cli, "reloc wait_idle failed: %d\n", ret);
+			drm_gem_object_put_unlocked(gem);
 			break;
 		}
 
-		nouveau_bo_wr32(nvbo, r->reloc_bo_offset >> 2, data);
+		ret = nouveau_gem_object_vma_get(nouveau_gem_object(gem), vmm,
+						 &vma);
+		if (ret) {
+			drm_gem_object_put_unlocked(gem);
+			break;
+		}
+
+		b->user_priv = (uint64_t)(unsigned long)vma;
+		bolist->bo[i].nvbo = nouveau_gem_object(gem);
+		bolist->nr_buffers = i + 1;
 	}
 
-	u_free(reloc);
-	return ret;
+	if (ret) {
+		nouveau_gem_bolist_del(bolist);
+		return ret;
+	}
+
+	do {
+		bolist->id = ++abi16->bolist_id;
+	} while (!bolist->id || nouveau_gem_bolist_find(abi16, bolist->id));
+
+	list_add_tail(&bolist->head, &abi16->bolists);
+	req->id = bolist->id;
+	return 0;
+}
+
+void
+nouveau_gem_bolist_fini(struct nouveau_abi16 *abi16)
+{
+	struct nouveau_gem_bolist *bolist, *temp;
+
+	list_for_each_entry_safe(bolist, temp, &abi16->bolists, head) {
+		nouveau_gem_bolist_del(bolist);
+	}
+}
+
+int
+nouveau_gem_ioctl_bolist(struct drm_device *dev, void *data,
+			 struct drm_file *file_priv)
+{
+	struct nouveau_abi16 *abi16 = nouveau_abi16_get(file_priv);
+	struct drm_nouveau_gem_bolist *req = data;
+	struct nouveau_gem_bolist *bolist;
+	int ret;
+
+	if (unlikely(!abi16))
+		return -ENOMEM;
+
+	switch (req->op) {
+	case NOUVEAU_GEM_BOLIST_NEW:
+		ret = nouveau_gem_bolist_new(abi16, file_priv, req);
+		break;
+	case NOUVEAU_GEM_BOLIST_DEL:
+		ret = -ENOENT;
+		if ((bolist = nouveau_gem_bolist_find(abi16, req->id))) {
+			nouveau_gem_bolist_del(bolist);
+			ret = 0;
+		}
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	return nouveau_abi16_put(abi16, ret);
 }
 
 int
@@ -692,8 +956,11 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 	struct drm_nouveau_gem_pushbuf_push *push;
 	struct drm_nouveau_gem_pushbuf_bo *bo;
 	struct nouveau_channel *chan = NULL;
+	struct nouveau_gem_bolist *bolist = NULL;
 	struct validate_op op;
 	struct nouveau_fence *fence = NULL;
+	u32 nr_buffers = req->nr_buffers;
+	bool no_reloc = req->flags & NOUVEAU_GEM_PUSHBUF_NO_RELOC;
 	int i, j, ret = 0, do_reloc = 0;
 
 	if (unlikely(!abi16))
@@ -732,19 +999,45 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 		return nouveau_abi16_put(abi16, -EINVAL);
 	}
 
+	if (unlikely(req->flags & ~NOUVEAU_GEM_PUSHBUF_NO_RELOC)) {
+		NV_PRINTK(err, cli, "pushbuf flags invalid: 0x%08x\n",
+			  req->flags);
+		return nouveau_abi16_put(abi16, -EINVAL);
+	}
+
+	if (no_reloc && (req->nr_relocs ||
+			 chan->vmm->vmm.object.oclass < NVIF_CLASS_VMM_NV50)) {
+		NV_PRINTK(err, cli, "pushbuf relocation-free submit invalid\n");
+		return nouveau_abi16_put(abi16, -EINVAL);
+	}
+
+	if (req->bolist) {
+		bolist = nouveau_gem_bolist_find(abi16, req->bolist);
+		if (!bolist || req->nr_buffers || bolist->vmm != chan->vmm) {
+			NV_PRINTK(err, cli, "pushbuf bo list %d invalid\n",
+				  req->bolist);
+			return nouveau_abi16_put(abi16, -EINVAL);
+		}
+		nr_buffers = bolist->nr_buffers;
+	}
+
 	push = u_memcpya(req->push, req->nr_push, sizeof(*push));
 	if (IS_ERR(push))
 		return nouveau_abi16_put(abi16, PTR_ERR(push));
 
-	bo = u_memcpya(req->buffers, req->nr_buffers, sizeof(*bo));
-	if (IS_ERR(bo)) {
-		u_free(push);
-		return nouveau_abi16_put(abi16, PTR_ERR(bo));
+	if (bolist) {
+		bo = bolist->pbbo;
+	} else {
+		bo = u_memcpya(req->buffers, req->nr_buffers, sizeof(*bo));
+		if (IS_ERR(bo)) {
+			u_free(push);
+			return nouveau_abi16_put(abi16, PTR_ERR(bo));
+		}
 	}
 
 	/* Ensure all push buffers are on validate list */
 	for (i = 0; i < req->nr_push; i++) {
-		if (push[i].bo_index >= req->nr_buffers) {
+		if (push[i].bo_index >= nr_buffers) {
 			NV_PRINTK(err, cli, "push %d buffer not in list\n", i);
 			ret = -EINVAL;
 			goto out_prevalid;
@@ -753,7 +1046,8 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 
 	/* Validate buffer list */
 	ret = nouveau_gem_pushbuf_validate(chan, file_priv, bo, req->buffers,
-					   req->nr_buffers, &op, &do_reloc);
+					   nr_buffers, bolist, no_reloc,
+					   &op, &do_reloc);
 	if (ret) {
 		if (ret != -ERESTARTSYS)
 			NV_PRINTK(err, cli, "validate: %d\n", ret);
@@ -769,6 +1063,8 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 		}
 	}
 
+	/* Nothing below runs under RCU, waiting for ring space may sleep. */
+	chan->dma.sleep = true;
 	if (chan->dma.ib_max) {
 		ret = nouveau_dma_wait(chan, req->nr_push + 1, 16);
 		if (ret) {
@@ -836,6 +1132,7 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 				OUT_RING(chan, 0);
 		}
 	}
+	chan->dma.sleep = false;
 
 	ret = nouveau_fence_new(chan, false, &fence);
 	if (ret) {
@@ -845,11 +1142,13 @@ nouveau_gem_ioctl_pushbuf(struct drm_device *dev, void *data,
 	}
 
 out:
+	chan->dma.sleep = false;
 	validate_fini(&op, chan, fence, bo);
 	nouveau_fence_unref(&fence);
 
 out_prevalid:
-	u_free(bo);
+	if (!bolist)
+		u_free(bo);
 	u_free(push);
 
 out_next:
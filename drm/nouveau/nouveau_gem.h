@@ -7,6 +7,8 @@
 #include "nouveau_drv.h"
 #include "nouveau_bo.h"
 
+struct nouveau_abi16;
+
 static inline struct nouveau_bo *
 nouveau_gem_object(struct drm_gem_object *gem)
 {
@@ -31,6 +33,9 @@ extern int nouveau_gem_ioctl_cpu_fini(struct drm_device *, void *,
 				      struct drm_file *);
 extern int nouveau_gem_ioctl_info(struct drm_device *, void *,
 				  struct drm_file *);
+extern int nouveau_gem_ioctl_bolist(struct drm_device *, void *,
+				    struct drm_file *);
+extern void nouveau_gem_bolist_fini(struct nouveau_abi16 *);
 
 extern int nouveau_gem_prime_pin(struct drm_gem_object *);
 struct reservation_object *nouveau_gem_prime_res_obj(struct drm_gem_object *);
@@ -39,6 +39,116 @@
 
 #if defined(CONFIG_HWMON) || (defined(MODULE) && defined(CONFIG_HWMON_MODULE))
 
+/* The worker stops once nobody has read a sensor for this many intervals. */
+#define NOUVEAU_HWMON_IDLE 10
+
+static void
+nouveau_hwmon_sample(struct nouveau_drm *drm, struct nouveau_hwmon_snap *snap)
+{
+	struct nvkm_iccsense *iccsense = nvxx_iccsense(&drm->client.device);
+	struct nvkm_therm *therm = nvxx_therm(&drm->client.device);
+	struct nvkm_volt *volt = nvxx_volt(&drm->client.device);
+
+	snap->temp = snap->fan = snap->volt = snap->power = -ENODEV;
+	if (therm && therm->attr_get)
+		snap->temp = nvkm_therm_temp_get(therm);
+	if (therm)
+		snap->fan = nvkm_therm_fan_sense(therm);
+	if (volt)
+		snap->volt = nvkm_volt_get(volt);
+	if (iccsense && iccsense->data_valid && !list_empty(&iccsense->rails))
+		snap->power = nvkm_iccsense_read_all(iccsense);
+	snap->time = jiffies;
+}
+
+static void
+nouveau_hwmon_work(struct work_struct *work)
+{
+	struct nouveau_hwmon *hwmon =
+		container_of(work, typeof(*hwmon), work.work);
+	struct nouveau_hwmon_snap snap;
+	unsigned long interval;
+	bool idle;
+
+	/* Sample without the lock held, the fan tach measurement takes a
+	 * while and readers can keep using the previous snapshot.
+	 */
+	nouveau_hwmon_sample(nouveau_drm(hwmon->dev), &snap);
+
+	mutex_lock(&hwmon->mutex);
+	interval = msecs_to_jiffies(hwmon->interval);
+	hwmon->snap = snap;
+	hwmon->valid = true;
+	idle = time_after(jiffies, hwmon->last_read +
+				   interval * NOUVEAU_HWMON_IDLE);
+	mutex_unlock(&hwmon->mutex);
+
+	if (!idle)
+		queue_delayed_work(system_freezable_wq, &hwmon->work, interval);
+}
+
+/* Returns the latest snapshot, or -ENODATA if sampling failed to produce
+ * one.  Readers never sample themselves (the fan tach alone takes ~250ms),
+ * but a snapshot older than two update intervals means the worker has gone
+ * idle, so it's kicked and waited for to keep what's returned fresh.
+ */
+static int
+nouveau_hwmon_snap(struct drm_device *dev, struct nouveau_hwmon_snap *snap)
+{
+	struct nouveau_hwmon *hwmon = nouveau_hwmon(dev);
+	unsigned long interval;
+	bool valid, stale;
+
+	mutex_lock(&hwmon->mutex);
+	interval = msecs_to_jiffies(hwmon->interval);
+	hwmon->last_read = jiffies;
+	stale = !hwmon->valid ||
+		time_after(jiffies, hwmon->snap.time + interval * 2);
+	mutex_unlock(&hwmon->mutex);
+
+	if (stale) {
+		mod_delayed_work(system_freezable_wq, &hwmon->work, 0);
+		flush_delayed_work(&hwmon->work);
+	}
+
+	mutex_lock(&hwmon->mutex);
+	valid = hwmon->valid;
+	*snap = hwmon->snap;
+	mutex_unlock(&hwmon->mutex);
+	return valid ? 0 : -ENODATA;
+}
+
+static ssize_t
+nouveau_hwmon_show_update_age(struct device *d,
+			      struct device_attribute *a, char *buf)
+{
+	struct drm_device *dev = dev_get_drvdata(d);
+	struct nouveau_hwmon *hwmon = nouveau_hwmon(dev);
+	unsigned long time;
+	bool valid;
+
+	mutex_lock(&hwmon->mutex);
+	time = hwmon->snap.time;
+	valid = hwmon->valid;
+	mutex_unlock(&hwmon->mutex);
+
+	if (!valid)
+		return -ENODATA;
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			jiffies_to_msecs(jiffies - time));
+}
+static SENSOR_DEVICE_ATTR(update_age, 0444,
+			  nouveau_hwmon_show_update_age, NULL, 0);
+
+static struct attribute *snap_attributes[] = {
+	&sensor_dev_attr_update_age.dev_attr.attr,
+	NULL
+};
+
+static const struct attribute_group snap_sensor_group = {
+	.attrs = snap_attributes,
+};
+
 static ssize_t
 nouveau_hwmon_show_temp1_auto_point1_pwm(struct device *d,
 					 struct device_attribute *a, char *buf)
@@ -211,7 +321,7 @@ static const struct attribute_group temp1_auto_point_sensor_group = {
 	.attrs = temp1_auto_point_sensor_attrs,
 };
 
-#define N_ATTR_GROUPS   3
+#define N_ATTR_GROUPS   4
 
 static const u32 nouveau_config_chip[] = {
 	HWMON_C_UPDATE_INTERVAL,
@@ -290,7 +400,7 @@ nouveau_chip_is_visible(const void *data, u32 attr, int channel)
 {
 	switch (attr) {
 	case hwmon_chip_update_interval:
-		return 0444;
+		return 0644;
 	default:
 		return 0;
 	}
@@ -404,9 +514,11 @@ nouveau_fan_is_visible(const void *data, u32 attr, int channel)
 static int
 nouveau_chip_read(struct device *dev, u32 attr, int channel, long *val)
 {
+	struct nouveau_hwmon *hwmon = nouveau_hwmon(dev_get_drvdata(dev));
+
 	switch (attr) {
 	case hwmon_chip_update_interval:
-		*val = 1000;
+		*val = hwmon->interval;
 		break;
 	default:
 		return -EOPNOTSUPP;
@@ -415,12 +527,29 @@ nouveau_chip_read(struct device *dev, u32 attr, int channel, long *val)
 	return 0;
 }
 
+static int
+nouveau_chip_write(struct device *dev, u32 attr, int channel, long val)
+{
+	struct nouveau_hwmon *hwmon = nouveau_hwmon(dev_get_drvdata(dev));
+
+	switch (attr) {
+	case hwmon_chip_update_interval:
+		mutex_lock(&hwmon->mutex);
+		hwmon->interval = clamp_val(val, 100, 60000);
+		mutex_unlock(&hwmon->mutex);
+		return 0;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
 static int
 nouveau_temp_read(struct device *dev, u32 attr, int channel, long *val)
 {
 	struct drm_device *drm_dev = dev_get_drvdata(dev);
 	struct nouveau_drm *drm = nouveau_drm(drm_dev);
 	struct nvkm_therm *therm = nvxx_therm(&drm->client.device);
+	struct nouveau_hwmon_snap snap;
 	int ret;
 
 	if (!therm || !therm->attr_get)
@@ -428,8 +557,10 @@ nouveau_temp_read(struct device *dev, u32 attr, int channel, long *val)
 
 	switch (attr) {
 	case hwmon_temp_input:
-		ret = nvkm_therm_temp_get(therm);
-		*val = ret < 0 ? ret : (ret * 1000);
+		ret = nouveau_hwmon_snap(drm_dev, &snap);
+		if (ret)
+			return ret;
+		*val = snap.temp < 0 ? snap.temp : (snap.temp * 1000);
 		break;
 	case hwmon_temp_max:
 		*val = therm->attr_get(therm, NVKM_THERM_ATTR_THRS_DOWN_CLK)
@@ -468,13 +599,18 @@ nouveau_fan_read(struct device *dev, u32 attr, int channel, long *val)
 	struct drm_device *drm_dev = dev_get_drvdata(dev);
 	struct nouveau_drm *drm = nouveau_drm(drm_dev);
 	struct nvkm_therm *therm = nvxx_therm(&drm->client.device);
+	struct nouveau_hwmon_snap snap;
+	int ret;
 
 	if (!therm)
 		return -EOPNOTSUPP;
 
 	switch (attr) {
 	case hwmon_fan_input:
-		*val = nvkm_therm_fan_sense(therm);
+		ret = nouveau_hwmon_snap(drm_dev, &snap);
+		if (ret)
+			return ret;
+		*val = snap.fan;
 		break;
 	default:
 		return -EOPNOTSUPP;
@@ -489,6 +625,7 @@ nouveau_in_read(struct device *dev, u32 attr, int channel, long *val)
 	struct drm_device *drm_dev = dev_get_drvdata(dev);
 	struct nouveau_drm *drm = nouveau_drm(drm_dev);
 	struct nvkm_volt *volt = nvxx_volt(&drm->client.device);
+	struct nouveau_hwmon_snap snap;
 	int ret;
 
 	if (!volt)
@@ -496,8 +633,10 @@ nouveau_in_read(struct device *dev, u32 attr, int channel, long *val)
 
 	switch (attr) {
 	case hwmon_in_input:
-		ret = nvkm_volt_get(volt);
-		*val = ret < 0 ? ret : (ret / 1000);
+		ret = nouveau_hwmon_snap(drm_dev, &snap);
+		if (ret)
+			return ret;
+		*val = snap.volt < 0 ? snap.volt : (snap.volt / 1000);
 		break;
 	case hwmon_in_min:
 		*val = volt->min_uv > 0 ? (volt->min_uv / 1000) : -ENODEV;
@@ -542,13 +681,18 @@ nouveau_power_read(struct device *dev, u32 attr, int channel, long *val)
 	struct drm_device *drm_dev = dev_get_drvdata(dev);
 	struct nouveau_drm *drm = nouveau_drm(drm_dev);
 	struct nvkm_iccsense *iccsense = nvxx_iccsense(&drm->client.device);
+	struct nouveau_hwmon_snap snap;
+	int ret;
 
 	if (!iccsense)
 		return -EOPNOTSUPP;
 
 	switch (attr) {
 	case hwmon_power_input:
-		*val = nvkm_iccsense_read_all(iccsense);
+		ret = nouveau_hwmon_snap(drm_dev, &snap);
+		if (ret)
+			return ret;
+		*val = snap.power;
 		break;
 	case hwmon_power_max:
 		*val = iccsense->power_w_max;
@@ -680,6 +824,8 @@ nouveau_write(struct device *dev, enum hwmon_sensor_types type, u32 attr,
 							int channel, long val)
 {
 	switch (type) {
+	case hwmon_chip:
+		return nouveau_chip_write(dev, attr, channel, val);
 	case hwmon_temp:
 		return nouveau_temp_write(dev, attr, channel, val);
 	case hwmon_pwm:
@@ -725,6 +871,10 @@ nouveau_hwmon_init(struct drm_device *dev)
 	if (!hwmon)
 		return -ENOMEM;
 	hwmon->dev = dev;
+	hwmon->interval = 1000;
+	mutex_init(&hwmon->mutex);
+	INIT_DELAYED_WORK(&hwmon->work, nouveau_hwmon_work);
+	special_groups[i++] = &snap_sensor_group;
 
 	if (therm && therm->attr_get && therm->attr_set) {
 		if (nvkm_therm_temp_get(therm) >= 0)
@@ -744,6 +894,9 @@ nouveau_hwmon_init(struct drm_device *dev)
 	}
 
 	hwmon->hwmon = hwmon_dev;
+
+	/* Have a snapshot ready for the first reader. */
+	queue_delayed_work(system_freezable_wq, &hwmon->work, 0);
 	return 0;
 #else
 	return 0;
@@ -761,6 +914,7 @@ nouveau_hwmon_fini(struct drm_device *dev)
 
 	if (hwmon->hwmon)
 		hwmon_device_unregister(hwmon->hwmon);
+	cancel_delayed_work_sync(&hwmon->work);
 
 	nouveau_drm(dev)->hwmon = NULL;
 	kfree(hwmon);
@@ -25,9 +25,28 @@
 #ifndef __NOUVEAU_PM_H__
 #define __NOUVEAU_PM_H__
 
+struct nouveau_hwmon_snap {
+	unsigned long time;
+	int temp;
+	int fan;
+	int volt;
+	int power;
+};
+
 struct nouveau_hwmon {
 	struct drm_device *dev;
 	struct device *hwmon;
+
+	/* Sensor readings are sampled together, and refreshed from a
+	 * worker every 'interval' ms for as long as they're being read.
+	 * Readers arriving after it's gone idle wait for a fresh sample.
+	 */
+	struct mutex mutex;
+	struct delayed_work work;
+	unsigned long last_read;
+	u32 interval;
+	bool valid;
+	struct nouveau_hwmon_snap snap;
 };
 
 static inline struct nouveau_hwmon *
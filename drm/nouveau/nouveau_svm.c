@@ -98,6 +98,12 @@ struct nouveau_svmm {
 
 	struct mm_struct *mm;
 	struct hmm_mirror mirror;
+
+	/* Fault-around state, only touched by the fault handler. */
+	struct {
+		u64 next;
+		u32 window;
+	} fault;
 };
 
 #define SVMM_DBG(s,f,a...)                                                     \
@@ -475,6 +481,53 @@ nouveau_svm_fault_cache(struct nouveau_svm *svm,
 		fault->inst, fault->addr, fault->access);
 }
 
+/* Pages serviced around a fault that doesn't continue a linear stream,
+ * the window doubles (up to the size of the PFNMAP batch) for each fault
+ * that lands where the previous window ended.
+ */
+#define NOUVEAU_SVM_FAULT_WINDOW 16
+
+static u32
+nouveau_svmm_fault_window(struct nouveau_svmm *svmm, u64 addr, u32 max)
+{
+	u64 next = svmm->fault.next;
+	u32 window = svmm->fault.window;
+
+	if (window && addr >= next && addr < next + ((u64)window << PAGE_SHIFT))
+		window = min(window * 2, max);
+	else
+		window = NOUVEAU_SVM_FAULT_WINDOW;
+
+	svmm->fault.window = window;
+	return window;
+}
+
+/* Rebuild the PFNMAP request for a window with only the pages the GPU has
+ * actually faulted on, dropping any gap and prefetch pages.
+ */
+static int
+nouveau_svm_fault_unprefetch(struct nouveau_svm_fault_buffer *buffer,
+			     int fi, int fn, u64 start, u64 *phys)
+{
+	int pi, pn = 0;
+
+	for (; fi < fn; fi++) {
+		struct nouveau_svm_fault *fault = buffer->fault[fi];
+
+		pi = (fault->addr - start) >> PAGE_SHIFT;
+		while (pn <= pi)
+			phys[pn++] = NVIF_VMM_PFNMAP_V0_NONE;
+
+		if (fault->access != 0 /* READ. */ &&
+		    fault->access != 3 /* PREFETCH. */)
+			phys[pi] |= NVIF_VMM_PFNMAP_V0_V | NVIF_VMM_PFNMAP_V0_W;
+		else
+			phys[pi] |= NVIF_VMM_PFNMAP_V0_V;
+	}
+
+	return pn;
+}
+
 static int
 nouveau_svm_fault(struct nvif_notify *notify)
 {
@@ -490,12 +543,12 @@ nouveau_svm_fault(struct nvif_notify *notify)
 			struct nvif_ioctl_mthd_v0 m;
 			struct nvif_vmm_pfnmap_v0 p;
 		} i;
-		u64 phys[16];
+		u64 phys[64];
 	} args;
 	struct hmm_range range;
 	struct vm_area_struct *vma;
-	u64 inst, start, limit;
-	int fi, fn, pi, fill;
+	u64 inst, start, limit, ahead;
+	int fi, fn, pi, fill, window;
 	int replay = 0, ret;
 
 	/* Parse available fault buffer entries into a cache, and update
@@ -555,11 +608,14 @@ nouveau_svm_fault(struct nvif_notify *notify)
 		}
 		SVMM_DBG(svmm, "addr %016llx", buffer->fault[fi]->addr);
 
-		/* We try and group handling of faults within a small
-		 * window into a single update.
+		/* We try and group handling of faults within a window
+		 * into a single update, which grows while the GPU walks
+		 * linearly through memory.
 		 */
 		start = buffer->fault[fi]->addr;
-		limit = start + (ARRAY_SIZE(args.phys) << PAGE_SHIFT);
+		window = nouveau_svmm_fault_window(svmm, start,
+						   ARRAY_SIZE(args.phys));
+		limit = start + ((u64)window << PAGE_SHIFT);
 		if (start < svmm->unmanaged.limit)
 			limit = min_t(u64, limit, svmm->unmanaged.start);
 		else
@@ -609,6 +665,18 @@ nouveau_svm_fault(struct nvif_notify *notify)
 			}
 			args.i.p.size = pi << PAGE_SHIFT;
 
+			/* Pages that haven't faulted yet are only mapped when
+			 * the window has grown, ie. the GPU is streaming, in
+			 * which case they're fetched with the permissions of
+			 * the fault before them.
+			 */
+			ahead = NVIF_VMM_PFNMAP_V0_NONE;
+			if (window > NOUVEAU_SVM_FAULT_WINDOW) {
+				ahead = args.phys[pi - 1];
+				if (!(vma->vm_flags & VM_WRITE))
+					ahead &= ~NVIF_VMM_PFNMAP_V0_W;
+			}
+
 			/* It's okay to skip over duplicate addresses from the
 			 * same SVMM as faults are ordered by access type such
 			 * that only the first one needs to be handled.
@@ -633,9 +701,17 @@ nouveau_svm_fault(struct nvif_notify *notify)
 			fill = (buffer->fault[fn    ]->addr -
 				buffer->fault[fn - 1]->addr) >> PAGE_SHIFT;
 			while (--fill)
-				args.phys[pi++] = NVIF_VMM_PFNMAP_V0_NONE;
+				args.phys[pi++] = ahead;
 		}
 
+		/* Prefetch the rest of the window ahead of the GPU. */
+		if (ahead != NVIF_VMM_PFNMAP_V0_NONE) {
+			while (args.i.p.addr + ((u64)pi << PAGE_SHIFT) < limit)
+				args.phys[pi++] = ahead;
+			args.i.p.size = pi << PAGE_SHIFT;
+		}
+		svmm->fault.next = args.i.p.addr + args.i.p.size;
+
 		SVMM_DBG(svmm, "wndw %016llx-%016llx covering %d fault(s)",
 			 args.i.p.addr,
 			 args.i.p.addr + args.i.p.size, fn - fi);
@@ -650,6 +726,27 @@ nouveau_svm_fault(struct nvif_notify *notify)
 		range.pfn_shift = NVIF_VMM_PFNMAP_V0_ADDR_SHIFT;
 again:
 		ret = hmm_vma_fault(&range, true);
+		if ((ret == -EFAULT || ret == -EPERM) &&
+		    window > NOUVEAU_SVM_FAULT_WINDOW) {
+			/* Prefetching is best-effort, a page the GPU hasn't
+			 * touched mustn't cause the real faults to be
+			 * cancelled.  Retry with just those.
+			 *
+			 * Only for errors that leave mmap_sem held, -EBUSY
+			 * and -EAGAIN have dropped it already.
+			 */
+			SVMM_DBG(svmm, "prefetch failed %d, retrying", ret);
+			window = NOUVEAU_SVM_FAULT_WINDOW;
+			svmm->fault.window = 0;
+			pi = nouveau_svm_fault_unprefetch(buffer, fi, fn,
+							  args.i.p.addr,
+							  args.phys);
+			args.i.p.size = pi << PAGE_SHIFT;
+			svmm->fault.next = args.i.p.addr + args.i.p.size;
+			range.end = args.i.p.addr + args.i.p.size;
+			goto again;
+		}
+
 		if (ret == 0) {
 			mutex_lock(&svmm->mutex);
 			if (!hmm_vma_range_done(&range)) {
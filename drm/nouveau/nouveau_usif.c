@@ -41,7 +41,6 @@ struct usif_notify_p {
 };
 
 struct usif_notify {
-	struct list_head head;
 	atomic_t enabled;
 	u32 handle;
 	u16 reply;
@@ -54,18 +53,15 @@ static inline struct usif_notify *
 usif_notify_find(struct drm_file *filp, u32 handle)
 {
 	struct nouveau_cli *cli = nouveau_cli(filp);
-	struct usif_notify *ntfy;
-	list_for_each_entry(ntfy, &cli->notifys, head) {
-		if (ntfy->handle == handle)
-			return ntfy;
-	}
+	if (handle < ARRAY_SIZE(cli->notifys))
+		return cli->notifys[handle];
 	return NULL;
 }
 
 static inline void
-usif_notify_dtor(struct usif_notify *ntfy)
+usif_notify_dtor(struct nouveau_cli *cli, struct usif_notify *ntfy)
 {
-	list_del(&ntfy->head);
+	cli->notifys[ntfy->handle] = NULL;
 	kfree(ntfy);
 }
 
@@ -156,8 +152,14 @@ usif_notify_new(struct drm_file *f, void *data, u32 size, void *argv, u32 argc)
 		ntfy->handle = args->v0.index;
 	}
 
-	if (ret == 0)
-		list_add(&ntfy->head, &cli->notifys);
+	if (ret == 0) {
+		if (WARN_ON(ntfy->handle >= ARRAY_SIZE(cli->notifys) ||
+			    cli->notifys[ntfy->handle])) {
+			/* nvkm may still route events to it, so leak it. */
+			return -EINVAL;
+		}
+		cli->notifys[ntfy->handle] = ntfy;
+	}
 	if (ret)
 		kfree(ntfy);
 	return ret;
@@ -182,7 +184,7 @@ usif_notify_del(struct drm_file *f, void *data, u32 size, void *argv, u32 argc)
 
 	ret = nvif_client_ioctl(client, argv, argc);
 	if (ret == 0)
-		usif_notify_dtor(ntfy);
+		usif_notify_dtor(cli, ntfy);
 	return ret;
 }
 
@@ -379,10 +381,11 @@ void
 usif_client_fini(struct nouveau_cli *cli)
 {
 	struct usif_object *object, *otemp;
-	struct usif_notify *notify, *ntemp;
+	int i;
 
-	list_for_each_entry_safe(notify, ntemp, &cli->notifys, head) {
-		usif_notify_dtor(notify);
+	for (i = 0; i < ARRAY_SIZE(cli->notifys); i++) {
+		if (cli->notifys[i])
+			usif_notify_dtor(cli, cli->notifys[i]);
 	}
 
 	list_for_each_entry_safe(object, otemp, &cli->objects, head) {
@@ -394,5 +397,5 @@ void
 usif_client_init(struct nouveau_cli *cli)
 {
 	INIT_LIST_HEAD(&cli->objects);
-	INIT_LIST_HEAD(&cli->notifys);
+	memset(cli->notifys, 0x00, sizeof(cli->notifys));
 }
@@ -25,6 +25,8 @@
 #include "nouveau_svm.h"
 #include "nouveau_mem.h"
 
+#include <linux/idr.h>
+
 void
 nouveau_vma_unmap(struct nouveau_vma *vma)
 {
@@ -45,17 +47,35 @@ nouveau_vma_map(struct nouveau_vma *vma, struct nouveau_mem *mem)
 	return 0;
 }
 
-struct nouveau_vma *
-nouveau_vma_find(struct nouveau_bo *nvbo, struct nouveau_vmm *vmm)
+/* Each VMM that maps a buffer gets a small id, so that a bo shared by
+ * many clients can find its vma directly rather than by walking vma_list.
+ */
+static DEFINE_IDA(nouveau_vmm_ida);
+
+static int
+nouveau_vmm_id(struct nouveau_vmm *vmm)
 {
-	struct nouveau_vma *vma;
+	int id = READ_ONCE(vmm->id);
+
+	if (!id) {
+		id = ida_alloc_min(&nouveau_vmm_ida, 1, GFP_KERNEL);
+		if (id < 0)
+			return id;
 
-	list_for_each_entry(vma, &nvbo->vma_list, head) {
-		if (vma->vmm == vmm)
-			return vma;
+		if (cmpxchg(&vmm->id, 0, id)) {
+			ida_free(&nouveau_vmm_ida, id);
+			id = vmm->id;
+		}
 	}
 
-	return NULL;
+	return id;
+}
+
+struct nouveau_vma *
+nouveau_vma_find(struct nouveau_bo *nvbo, struct nouveau_vmm *vmm)
+{
+	int id = READ_ONCE(vmm->id);
+	return id ? xa_load(&nvbo->vma_xa, id) : NULL;
 }
 
 void
@@ -67,6 +87,7 @@ nouveau_vma_del(struct nouveau_vma **pvma)
 			struct nvif_vma tmp = { .addr = vma->addr, .size = 1 };
 			nvif_vmm_put(&vma->vmm->vmm, &tmp);
 		}
+		xa_erase(&vma->nvbo->vma_xa, vma->vmm->id);
 		list_del(&vma->head);
 		kfree(*pvma);
 		*pvma = NULL;
@@ -80,16 +101,28 @@ nouveau_vma_new(struct nouveau_bo *nvbo, struct nouveau_vmm *vmm,
 	struct nouveau_mem *mem = nouveau_mem(&nvbo->bo.mem);
 	struct nouveau_vma *vma;
 	struct nvif_vma tmp;
-	int ret;
+	int ret, id;
 
 	if ((vma = *pvma = nouveau_vma_find(nvbo, vmm))) {
 		vma->refs++;
 		return 0;
 	}
 
+	if ((id = nouveau_vmm_id(vmm)) < 0)
+		return id;
+
 	if (!(vma = *pvma = kmalloc(sizeof(*vma), GFP_KERNEL)))
 		return -ENOMEM;
+
+	ret = xa_err(xa_store(&nvbo->vma_xa, id, vma, GFP_KERNEL));
+	if (ret) {
+		kfree(vma);
+		*pvma = NULL;
+		return ret;
+	}
+
 	vma->vmm = vmm;
+	vma->nvbo = nvbo;
 	vma->refs = 1;
 	vma->addr = ~0ULL;
 	vma->mem = NULL;
@@ -123,6 +156,10 @@ nouveau_vmm_fini(struct nouveau_vmm *vmm)
 	nouveau_svmm_fini(&vmm->svmm);
 	nvif_vmm_fini(&vmm->vmm);
 	vmm->cli = NULL;
+	if (vmm->id) {
+		ida_free(&nouveau_vmm_ida, vmm->id);
+		vmm->id = 0;
+	}
 }
 
 int
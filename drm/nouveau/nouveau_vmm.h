@@ -6,6 +6,7 @@ struct nouveau_mem;
 
 struct nouveau_vma {
 	struct nouveau_vmm *vmm;
+	struct nouveau_bo *nvbo;
 	int refs;
 	struct list_head head;
 	u64 addr;
@@ -26,6 +27,7 @@ struct nouveau_vmm {
 	struct nouveau_cli *cli;
 	struct nvif_vmm vmm;
 	struct nouveau_svmm *svmm;
+	int id; /* index into nouveau_bo.vma_xa, 0 until first used */
 };
 
 int nouveau_vmm_init(struct nouveau_cli *, s32 oclass, struct nouveau_vmm *);
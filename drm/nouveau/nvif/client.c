@@ -81,6 +81,9 @@ nvif_client_init(struct nvif_client *parent, const char *name, u64 device,
 	client->route = NVIF_IOCTL_V0_ROUTE_NVIF;
 	client->super = true;
 	client->driver = parent->driver;
+	mutex_init(&client->automap.mutex);
+	INIT_LIST_HEAD(&client->automap.list);
+	client->automap.limit = 32;
 
 	if (ret == 0) {
 		ret = nvif_client_ioctl(client, &nop, sizeof(nop));
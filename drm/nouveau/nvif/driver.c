@@ -32,6 +32,9 @@ nvif_driver[] = {
 	&nvif_driver_drm,
 	&nvif_driver_lib,
 	&nvif_driver_null,
+	/* "null" always succeeds, these are only used when asked for. */
+	&nvif_driver_lib_ring,
+	&nvif_driver_ipc,
 #endif
 	NULL
 };
@@ -99,3 +99,166 @@ nvif_mem_init(struct nvif_mmu *mmu, s32 oclass, u8 type, u8 page,
 
 	return ret;
 }
+
+struct nvif_mem_slab {
+	struct nvif_mem mem;
+	struct list_head head;
+	u8  shift;
+	u16 nr;
+	u16 used;
+	DECLARE_BITMAP(busy, NVIF_MEM_POOL_SLAB / NVIF_MEM_POOL_MIN);
+};
+
+static struct nvif_mem_slab *
+nvif_mem_pool_slab(struct nvif_mem_pool *pool, u8 shift)
+{
+	struct nvif_mem_slab *slab;
+	int ret;
+
+	list_for_each_entry(slab, &pool->slabs, head) {
+		if (slab->shift == shift && slab->used < slab->nr)
+			return slab;
+	}
+
+	if (!(slab = kzalloc(sizeof(*slab), GFP_KERNEL)))
+		return NULL;
+
+	ret = nvif_mem_init_map(pool->mmu, pool->type, NVIF_MEM_POOL_SLAB,
+				&slab->mem);
+	if (ret) {
+		kfree(slab);
+		return NULL;
+	}
+
+	slab->shift = shift;
+	slab->nr = NVIF_MEM_POOL_SLAB >> shift;
+	list_add(&slab->head, &pool->slabs);
+	pool->stat.slabs++;
+	pool->stat.size += NVIF_MEM_POOL_SLAB;
+	return slab;
+}
+
+/* Keep one empty slab per size class around, so that alloc/free cycles
+ * at the boundary don't keep recreating (and remapping) nvif_mem objects.
+ */
+static bool
+nvif_mem_pool_spare(struct nvif_mem_pool *pool, struct nvif_mem_slab *empty)
+{
+	struct nvif_mem_slab *slab;
+
+	list_for_each_entry(slab, &pool->slabs, head) {
+		if (slab != empty && slab->shift == empty->shift && !slab->used)
+			return true;
+	}
+
+	return false;
+}
+
+void
+nvif_mem_pool_put(struct nvif_mem_sub *sub)
+{
+	struct nvif_mem_pool *pool = sub->pool;
+	struct nvif_mem_slab *slab = sub->slab;
+
+	if (!pool)
+		return;
+
+	if (!slab) {
+		nvif_mem_fini(sub->mem);
+		kfree(sub->mem);
+		sub->pool = NULL;
+		return;
+	}
+
+	mutex_lock(&pool->mutex);
+	__clear_bit(sub->offset >> slab->shift, slab->busy);
+	pool->stat.used -= sub->size;
+	if (--slab->used == 0 && nvif_mem_pool_spare(pool, slab)) {
+		list_del(&slab->head);
+		pool->stat.size -= NVIF_MEM_POOL_SLAB;
+		nvif_mem_fini(&slab->mem);
+		kfree(slab);
+	}
+	mutex_unlock(&pool->mutex);
+	sub->pool = NULL;
+}
+
+int
+nvif_mem_pool_get(struct nvif_mem_pool *pool, u64 size,
+		  struct nvif_mem_sub *sub)
+{
+	struct nvif_mem_slab *slab;
+	u8 shift;
+	int ret, i;
+
+	sub->pool = NULL;
+	if (!size)
+		return -EINVAL;
+
+	if (size > NVIF_MEM_POOL_MAX) {
+		if (!(sub->mem = kzalloc(sizeof(*sub->mem), GFP_KERNEL)))
+			return -ENOMEM;
+
+		ret = nvif_mem_init_map(pool->mmu, pool->type, size, sub->mem);
+		if (ret) {
+			kfree(sub->mem);
+			return ret;
+		}
+
+		mutex_lock(&pool->mutex);
+		pool->stat.objects++;
+		mutex_unlock(&pool->mutex);
+		sub->pool = pool;
+		sub->slab = NULL;
+		sub->offset = 0;
+		sub->size = size;
+		sub->ptr = sub->mem->object.map.ptr;
+		return 0;
+	}
+
+	shift = max(order_base_2(size), order_base_2(NVIF_MEM_POOL_MIN));
+
+	mutex_lock(&pool->mutex);
+	if (!(slab = nvif_mem_pool_slab(pool, shift))) {
+		mutex_unlock(&pool->mutex);
+		return -ENOMEM;
+	}
+
+	i = find_first_zero_bit(slab->busy, slab->nr);
+	__set_bit(i, slab->busy);
+	slab->used++;
+	pool->stat.allocs++;
+	pool->stat.used += 1ULL << shift;
+	mutex_unlock(&pool->mutex);
+
+	sub->pool = pool;
+	sub->slab = slab;
+	sub->mem = &slab->mem;
+	sub->offset = (u64)i << shift;
+	sub->size = 1ULL << shift;
+	sub->ptr = (u8 __iomem *)slab->mem.object.map.ptr + sub->offset;
+	return 0;
+}
+
+void
+nvif_mem_pool_fini(struct nvif_mem_pool *pool)
+{
+	struct nvif_mem_slab *slab, *temp;
+
+	list_for_each_entry_safe(slab, temp, &pool->slabs, head) {
+		WARN_ON(slab->used);
+		list_del(&slab->head);
+		nvif_mem_fini(&slab->mem);
+		kfree(slab);
+	}
+}
+
+void
+nvif_mem_pool_init(struct nvif_mmu *mmu, u8 type, struct nvif_mem_pool *pool)
+{
+	pool->mmu = mmu;
+	pool->type = type;
+	mutex_init(&pool->mutex);
+	INIT_LIST_HEAD(&pool->slabs);
+	memset(&pool->stat, 0x00, sizeof(pool->stat));
+}
@@ -154,7 +154,12 @@ nvif_notify_fini(struct nvif_notify *notify)
 	};
 	int ret = nvif_notify_put(notify);
 	if (ret >= 0 && object) {
+		struct nvif_client *client = object->client;
 		ret = nvif_object_ioctl(object, &args, sizeof(args), NULL);
+		if (client->driver->ntfy_del) {
+			client->driver->ntfy_del(client->object.priv,
+						 (unsigned long)(void *)notify);
+		}
 		notify->object = NULL;
 		kfree((void *)notify->data);
 	}
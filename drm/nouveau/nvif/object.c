@@ -62,9 +62,12 @@ nvif_object_sclass_get(struct nvif_object *object, struct nvif_sclass **psclass)
 		struct nvif_ioctl_v0 ioctl;
 		struct nvif_ioctl_sclass_v0 sclass;
 	} *args = NULL;
-	int ret, cnt = 0, i;
+	int ret, cnt = 32, i;
 	u32 size;
 
+	/* Start with room for a typical class list, so that a single
+	 * round trip is usually enough.
+	 */
 	while (1) {
 		size = sizeof(*args) + cnt * sizeof(args->sclass.oclass[0]);
 		if (!(args = kmalloc(size, GFP_KERNEL)))
@@ -99,6 +102,93 @@ nvif_object_sclass_get(struct nvif_object *object, struct nvif_sclass **psclass)
 	return ret;
 }
 
+/* Caller holds client->automap.mutex. */
+static void
+nvif_object_automap_del(struct nvif_object *object)
+{
+	struct nvif_client *client = object->client;
+	if (object->automap.mapped) {
+		list_del(&object->automap.head);
+		client->automap.count--;
+		object->automap.mapped = false;
+	}
+}
+
+static void
+nvif_object_unmap_(struct nvif_object *object)
+{
+	struct nvif_client *client = object->client;
+
+	object->automap.access = 0;
+	if (object->map.ptr) {
+		if (object->map.size) {
+			client->driver->unmap(client, object->map.ptr,
+						      object->map.size);
+			object->map.size = 0;
+		}
+		object->map.ptr = NULL;
+		nvif_object_unmap_handle(object);
+	}
+}
+
+/* Returns true if [addr, addr + size) can be accessed through the object's
+ * mapping, which is made here once the object has seen enough ioctls.  The
+ * mutex is then left held so the mapping can't be evicted by another thread
+ * under the access, and the caller must drop it once done.
+ */
+static bool
+nvif_object_automap(struct nvif_object *object, u64 addr, int size)
+{
+	struct nvif_client *client = object->client;
+	struct nvif_object *oldest;
+	u32 threshold = client->driver->automap;
+	bool ret = false;
+
+	if (!threshold)
+		return false;
+
+	mutex_lock(&client->automap.mutex);
+	if (object->automap.unsupported)
+		goto done;
+
+	if (!object->map.ptr) {
+		if (++object->automap.access < threshold)
+			goto done;
+
+		if (client->automap.count >= client->automap.limit) {
+			oldest = list_first_entry(&client->automap.list,
+						  typeof(*oldest), automap.head);
+			nvif_object_automap_del(oldest);
+			nvif_object_unmap_(oldest);
+			client->automap.evicted++;
+		}
+
+		/* Only IO mappings can be used with ioread/iowrite, and
+		 * they're the only ones that carry a size.
+		 */
+		if (nvif_object_map(object, NULL, 0) || !object->map.size) {
+			if (object->map.ptr)
+				nvif_object_unmap_(object);
+			object->automap.unsupported = true;
+			client->automap.failed++;
+			goto done;
+		}
+
+		list_add_tail(&object->automap.head, &client->automap.list);
+		client->automap.count++;
+		client->automap.mapped++;
+		object->automap.mapped = true;
+	}
+
+	/* Leave anything outside the mapping to the ioctl to reject. */
+	ret = addr + size <= object->map.size;
+	if (ret)
+		return true;
+done:
+	mutex_unlock(&client->automap.mutex);
+	return ret;
+}
+
 u32
 nvif_object_rd(struct nvif_object *object, int size, u64 addr)
 {
@@ -110,7 +200,26 @@ nvif_object_rd(struct nvif_object *object, int size, u64 addr)
 		.rd.size = size,
 		.rd.addr = addr,
 	};
-	int ret = nvif_object_ioctl(object, &args, sizeof(args), NULL);
+	int ret;
+
+	if (nvif_object_automap(object, addr, size)) {
+		u8 __iomem *ptr = (u8 __iomem *)object->map.ptr + addr;
+		u32 data;
+		switch (size) {
+		case 1: data = ioread8(ptr); break;
+		case 2: data = ioread16_native(ptr); break;
+		case 4: data = ioread32_native(ptr); break;
+		default:
+			mutex_unlock(&object->client->automap.mutex);
+			goto ioctl;
+		}
+		mutex_unlock(&object->client->automap.mutex);
+		return data;
+	}
+
+ioctl:
+
+	ret = nvif_object_ioctl(object, &args, sizeof(args), NULL);
 	if (ret) {
 		/*XXX: warn? */
 		return 0;
@@ -130,7 +239,25 @@ nvif_object_wr(struct nvif_object *object, int size, u64 addr, u32 data)
 		.wr.addr = addr,
 		.wr.data = data,
 	};
-	int ret = nvif_object_ioctl(object, &args, sizeof(args), NULL);
+	int ret;
+
+	if (nvif_object_automap(object, addr, size)) {
+		u8 __iomem *ptr = (u8 __iomem *)object->map.ptr + addr;
+		switch (size) {
+		case 1: iowrite8(data, ptr); break;
+		case 2: iowrite16_native(data, ptr); break;
+		case 4: iowrite32_native(data, ptr); break;
+		default:
+			mutex_unlock(&object->client->automap.mutex);
+			goto ioctl;
+		}
+		mutex_unlock(&object->client->automap.mutex);
+		return;
+	}
+
+ioctl:
+
+	ret = nvif_object_ioctl(object, &args, sizeof(args), NULL);
 	if (ret) {
 		/*XXX: warn? */
 	}
@@ -206,15 +333,17 @@ void
 nvif_object_unmap(struct nvif_object *object)
 {
 	struct nvif_client *client = object->client;
-	if (object->map.ptr) {
-		if (object->map.size) {
-			client->driver->unmap(client, object->map.ptr,
-						      object->map.size);
-			object->map.size = 0;
-		}
-		object->map.ptr = NULL;
-		nvif_object_unmap_handle(object);
+
+	/* Wait out any nvif_object_rd/wr() still using the mapping. */
+	if (client->driver->automap) {
+		mutex_lock(&client->automap.mutex);
+		nvif_object_automap_del(object);
+		nvif_object_unmap_(object);
+		mutex_unlock(&client->automap.mutex);
+		return;
 	}
+
+	nvif_object_unmap_(object);
 }
 
 int
@@ -222,7 +351,13 @@ nvif_object_map(struct nvif_object *object, void *argv, u32 argc)
 {
 	struct nvif_client *client = object->client;
 	u64 handle, length;
-	int ret = nvif_object_map_handle(object, argv, argc, &handle, &length);
+	int ret;
+
+	/* Replace any mapping made behind the caller's back. */
+	if (object->automap.mapped)
+		nvif_object_unmap(object);
+
+	ret = nvif_object_map_handle(object, argv, argc, &handle, &length);
 	if (ret >= 0) {
 		if (ret) {
 			object->map.ptr = client->driver->map(client,
@@ -274,6 +409,9 @@ nvif_object_init(struct nvif_object *parent, u32 handle, s32 oclass,
 	object->oclass = oclass;
 	object->map.ptr = NULL;
 	object->map.size = 0;
+	object->automap.access = 0;
+	object->automap.mapped = false;
+	object->automap.unsupported = false;
 
 	if (parent) {
 		if (!(args = kmalloc(sizeof(*args) + size, GFP_KERNEL))) {
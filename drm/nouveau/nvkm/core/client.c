@@ -271,7 +271,10 @@ nvkm_client_dtor(struct nvkm_object *object)
 	int i;
 	for (i = 0; i < ARRAY_SIZE(client->notify); i++)
 		nvkm_client_notify_del(client, i);
-	return client;
+	client->dead = true;
+
+	/* Otherwise, the last nvkm_ioctl() to finish frees it. */
+	return refcount_dec_and_test(&client->users) ? client : NULL;
 }
 
 static const struct nvkm_object_func
@@ -303,5 +306,7 @@ nvkm_client_new(const char *name, u64 device, const char *cfg,
 	client->ntfy = ntfy;
 	INIT_LIST_HEAD(&client->umem);
 	spin_lock_init(&client->lock);
+	init_rwsem(&client->ioctl);
+	refcount_set(&client->users, 1);
 	return 0;
 }
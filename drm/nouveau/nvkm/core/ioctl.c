@@ -79,6 +79,52 @@ nvkm_ioctl_sclass(struct nvkm_client *client,
 	return ret;
 }
 
+static int
+nvkm_ioctl_new_sclass(struct nvkm_client *client, struct nvkm_object *parent,
+		      struct nvif_ioctl_new_v0 *args, int index,
+		      struct nvkm_oclass *oclass)
+{
+	memset(oclass, 0x00, sizeof(*oclass));
+	oclass->handle = args->handle;
+	oclass->route  = args->route;
+	oclass->token  = args->token;
+	oclass->object = args->object;
+	oclass->client = client;
+	oclass->parent = parent;
+	return parent->func->sclass(parent, index, oclass);
+}
+
+static int
+nvkm_ioctl_new_oclass(struct nvkm_client *client, struct nvkm_object *parent,
+		      struct nvif_ioctl_new_v0 *args, struct nvkm_oclass *oclass)
+{
+	const u32 hash = (args->oclass ^ (args->oclass >> 8)) %
+			 ARRAY_SIZE(client->sclass);
+	typeof(client->sclass[0]) *hint = &client->sclass[hash];
+	int ret, i = 0;
+
+	/* The set of classes can differ between objects of the same type,
+	 * so a hint is only trusted once sclass() has confirmed it.
+	 */
+	if (hint->func == parent->func && hint->oclass == args->oclass) {
+		ret = nvkm_ioctl_new_sclass(client, parent, args,
+					    hint->index, oclass);
+		if (ret == 0 && oclass->base.oclass == args->oclass)
+			return 0;
+	}
+
+	do {
+		ret = nvkm_ioctl_new_sclass(client, parent, args, i++, oclass);
+		if (ret)
+			return ret;
+	} while (oclass->base.oclass != args->oclass);
+
+	hint->func = parent->func;
+	hint->oclass = args->oclass;
+	hint->index = i - 1;
+	return 0;
+}
+
 static int
 nvkm_ioctl_new(struct nvkm_client *client,
 	       struct nvkm_object *parent, void *data, u32 size)
@@ -88,7 +134,7 @@ nvkm_ioctl_new(struct nvkm_client *client,
 	} *args = data;
 	struct nvkm_object *object = NULL;
 	struct nvkm_oclass oclass;
-	int ret = -ENOSYS, i = 0;
+	int ret = -ENOSYS;
 
 	nvif_ioctl(parent, "new size %d\n", size);
 	if (!(ret = nvif_unpack(ret, &data, &size, args->v0, 0, 0, true))) {
@@ -104,18 +150,9 @@ nvkm_ioctl_new(struct nvkm_client *client,
 		return -EINVAL;
 	}
 
-	do {
-		memset(&oclass, 0x00, sizeof(oclass));
-		oclass.handle = args->v0.handle;
-		oclass.route  = args->v0.route;
-		oclass.token  = args->v0.token;
-		oclass.object = args->v0.object;
-		oclass.client = client;
-		oclass.parent = parent;
-		ret = parent->func->sclass(parent, i++, &oclass);
-		if (ret)
-			return ret;
-	} while (oclass.base.oclass != args->v0.oclass);
+	ret = nvkm_ioctl_new_oclass(client, parent, &args->v0, &oclass);
+	if (ret)
+		return ret;
 
 	if (oclass.engine) {
 		oclass.engine = nvkm_engine_ref(oclass.engine);
@@ -380,21 +417,22 @@ nvkm_ioctl_ntfy_put(struct nvkm_client *client,
 static struct {
 	int version;
 	int (*func)(struct nvkm_client *, struct nvkm_object *, void *, u32);
+	bool shared;
 }
 nvkm_ioctl_v0[] = {
-	{ 0x00, nvkm_ioctl_nop },
-	{ 0x00, nvkm_ioctl_sclass },
+	{ 0x00, nvkm_ioctl_nop, true },
+	{ 0x00, nvkm_ioctl_sclass, true },
 	{ 0x00, nvkm_ioctl_new },
 	{ 0x00, nvkm_ioctl_del },
 	{ 0x00, nvkm_ioctl_mthd },
-	{ 0x00, nvkm_ioctl_rd },
-	{ 0x00, nvkm_ioctl_wr },
+	{ 0x00, nvkm_ioctl_rd, true },
+	{ 0x00, nvkm_ioctl_wr, true },
 	{ 0x00, nvkm_ioctl_map },
 	{ 0x00, nvkm_ioctl_unmap },
 	{ 0x00, nvkm_ioctl_ntfy_new },
 	{ 0x00, nvkm_ioctl_ntfy_del },
-	{ 0x00, nvkm_ioctl_ntfy_get },
-	{ 0x00, nvkm_ioctl_ntfy_put },
+	{ 0x00, nvkm_ioctl_ntfy_get, true },
+	{ 0x00, nvkm_ioctl_ntfy_put, true },
 };
 
 static int
@@ -425,6 +463,21 @@ nvkm_ioctl_path(struct nvkm_client *client, u64 handle, u32 type,
 	return ret;
 }
 
+static bool
+nvkm_ioctl_lock(struct nvkm_client *client, bool supervisor, u8 type)
+{
+	if (type < ARRAY_SIZE(nvkm_ioctl_v0) && nvkm_ioctl_v0[type].shared) {
+		down_read(&client->ioctl);
+		if (client->super == supervisor)
+			return true;
+		up_read(&client->ioctl);
+	}
+
+	down_write(&client->ioctl);
+	client->super = supervisor;
+	return false;
+}
+
 int
 nvkm_ioctl(struct nvkm_client *client, bool supervisor,
 	   void *data, u32 size, void **hack)
@@ -433,28 +486,48 @@ nvkm_ioctl(struct nvkm_client *client, bool supervisor,
 	union {
 		struct nvif_ioctl_v0 v0;
 	} *args = data;
+	bool shared = false;
 	int ret = -ENOSYS;
 
-	client->super = supervisor;
 	nvif_ioctl(object, "size %d\n", size);
+	refcount_inc(&client->users);
 
 	if (!(ret = nvif_unpack(ret, &data, &size, args->v0, 0, 0, true))) {
 		nvif_ioctl(object,
 			   "vers %d type %02x object %016llx owner %02x\n",
 			   args->v0.version, args->v0.type, args->v0.object,
 			   args->v0.owner);
-		ret = nvkm_ioctl_path(client, args->v0.object, args->v0.type,
-				      data, size, args->v0.owner,
-				      &args->v0.route, &args->v0.token);
+		shared = nvkm_ioctl_lock(client, supervisor, args->v0.type);
+		if (client->dead) {
+			nvif_ioctl(object, "client deleted\n");
+			ret = -ENODEV;
+		} else {
+			ret = nvkm_ioctl_path(client, args->v0.object,
+					      args->v0.type, data, size,
+					      args->v0.owner, &args->v0.route,
+					      &args->v0.token);
+		}
+	} else {
+		down_write(&client->ioctl);
+		client->super = supervisor;
 	}
 
 	if (ret != 1) {
 		nvif_ioctl(object, "return %d\n", ret);
 		if (hack) {
-			*hack = client->data;
-			client->data = NULL;
+			/* Only set by "new", which is never shared. */
+			*hack = shared ? NULL : client->data;
+			if (!shared)
+				client->data = NULL;
 		}
 	}
 
+	if (shared)
+		up_read(&client->ioctl);
+	else
+		up_write(&client->ioctl);
+
+	if (refcount_dec_and_test(&client->users))
+		kfree(client);
 	return ret;
 }
@@ -25,6 +25,7 @@
 #include <core/mm.h>
 #include <subdev/fb.h>
 #include <subdev/instmem.h>
+#include <subdev/ltc.h>
 
 void
 nvkm_memory_tags_put(struct nvkm_memory *memory, struct nvkm_device *device,
@@ -35,6 +36,10 @@ nvkm_memory_tags_put(struct nvkm_memory *memory, struct nvkm_device *device,
 	if (tags) {
 		mutex_lock(&fb->subdev.mutex);
 		if (refcount_dec_and_test(&tags->refcount)) {
+			if (tags->mn) {
+				nvkm_ltc_tags_free(device, tags->mn->offset,
+						   tags->mn->length);
+			}
 			nvkm_mm_free(&fb->tags, &tags->mn);
 			kfree(memory->tags);
 			memory->tags = NULL;
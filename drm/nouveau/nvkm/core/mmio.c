@@ -0,0 +1,211 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <core/device.h>
+
+#ifdef CONFIG_NOUVEAU_DEBUG_MMIO
+/* Every nvkm_rd/wr/mask() expansion owns a static nvkm_mmio_site, which
+ * is linked onto a global list the first time it's hit.  Counters are
+ * updated without locking, so concurrent accesses may occasionally lose
+ * an increment, which is fine for finding where the traffic comes from.
+ */
+#define NVKM_MMIO_PAGES 0x1000 /* 4KiB pages of a 16MiB BAR0 */
+
+static DEFINE_SPINLOCK(nvkm_mmio_lock);
+static struct nvkm_mmio_site *nvkm_mmio_sites;
+static struct {
+	u64 rd;
+	u64 wr;
+} nvkm_mmio_page[NVKM_MMIO_PAGES];
+
+static inline void
+nvkm_mmio_site_add(struct nvkm_mmio_site *site)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&nvkm_mmio_lock, flags);
+	if (!site->listed) {
+		site->next = nvkm_mmio_sites;
+		nvkm_mmio_sites = site;
+		site->listed = true;
+	}
+	spin_unlock_irqrestore(&nvkm_mmio_lock, flags);
+}
+
+static inline void
+nvkm_mmio_site_acct(struct nvkm_mmio_site *site, ktime_t time)
+{
+	if (unlikely(!site->listed))
+		nvkm_mmio_site_add(site);
+	site->ns += ktime_to_ns(ktime_get()) - ktime_to_ns(time);
+}
+
+u32
+nvkm_mmio_rd(const struct nvkm_device *device, u32 addr, int size,
+	     struct nvkm_mmio_site *site)
+{
+	ktime_t time = ktime_get();
+	u32 data;
+
+	switch (size) {
+	case 1: data = ioread8(device->pri + addr); break;
+	case 2: data = ioread16_native(device->pri + addr); break;
+	default:
+		data = ioread32_native(device->pri + addr);
+		break;
+	}
+
+	nvkm_mmio_page[(addr >> 12) % NVKM_MMIO_PAGES].rd++;
+	site->rd++;
+	nvkm_mmio_site_acct(site, time);
+	return data;
+}
+
+void
+nvkm_mmio_wr(const struct nvkm_device *device, u32 addr, int size, u32 data,
+	     struct nvkm_mmio_site *site)
+{
+	ktime_t time = ktime_get();
+
+	switch (size) {
+	case 1: iowrite8(data, device->pri + addr); break;
+	case 2: iowrite16_native(data, device->pri + addr); break;
+	default:
+		iowrite32_native(data, device->pri + addr);
+		break;
+	}
+
+	nvkm_mmio_page[(addr >> 12) % NVKM_MMIO_PAGES].wr++;
+	site->wr++;
+	nvkm_mmio_site_acct(site, time);
+}
+
+u32
+nvkm_mmio_mask(const struct nvkm_device *device, u32 addr, u32 mask, u32 data,
+	       struct nvkm_mmio_site *site)
+{
+	ktime_t time = ktime_get();
+	u32 temp = ioread32_native(device->pri + addr);
+
+	iowrite32_native((temp & ~mask) | data, device->pri + addr);
+	nvkm_mmio_page[(addr >> 12) % NVKM_MMIO_PAGES].rd++;
+	nvkm_mmio_page[(addr >> 12) % NVKM_MMIO_PAGES].wr++;
+	site->mask++;
+	nvkm_mmio_site_acct(site, time);
+	return temp;
+}
+
+/* Attribute a site to the subdev/engine directory it lives in, ie.
+ * ".../nvkm/subdev/fb/gf100.c" becomes "subdev/fb".
+ */
+static int
+nvkm_mmio_unit(const char *file, const char **unit)
+{
+	const char *base = strstr(file, "nvkm/"), *end;
+
+	if (!base) {
+		*unit = file;
+		return strlen(file);
+	}
+
+	*unit = base += 5;
+	if (!(end = strchr(base, '/')) || !(end = strchr(end + 1, '/')))
+		return strlen(base);
+	return end - base;
+}
+
+static DEFINE_MUTEX(nvkm_mmio_dump_mutex);
+static struct {
+	const char *name;
+	int len;
+	u64 rd, wr, mask, ns;
+} nvkm_mmio_unit_stat[64];
+
+void
+nvkm_mmio_dump(void (*print)(void *, const char *, ...), void *priv)
+{
+	typeof(nvkm_mmio_unit_stat[0]) *unit = nvkm_mmio_unit_stat;
+	struct nvkm_mmio_site *site;
+	int units = 0, i;
+
+	mutex_lock(&nvkm_mmio_dump_mutex);
+	print(priv, "%-48s %10s %10s %10s %12s\n",
+	      "site", "rd", "wr", "mask", "ns");
+	for (site = nvkm_mmio_sites; site; site = site->next) {
+		const char *name;
+		int len = nvkm_mmio_unit(site->file, &name);
+
+		print(priv, "%s:%d %s() %10llu %10llu %10llu %12llu\n",
+		      name, site->line, site->func,
+		      site->rd, site->wr, site->mask, site->ns);
+
+		for (i = 0; i < units; i++) {
+			if (unit[i].len == len &&
+			    !strncmp(unit[i].name, name, len))
+				break;
+		}
+
+		if (i == units) {
+			if (units == ARRAY_SIZE(nvkm_mmio_unit_stat))
+				continue;
+			memset(&unit[units], 0x00, sizeof(unit[units]));
+			unit[units].name = name;
+			unit[units].len = len;
+			units++;
+		}
+
+		unit[i].rd += site->rd;
+		unit[i].wr += site->wr;
+		unit[i].mask += site->mask;
+		unit[i].ns += site->ns;
+	}
+
+	print(priv, "\n%-48s %10s %10s %10s %12s\n",
+	      "unit", "rd", "wr", "mask", "ns");
+	for (i = 0; i < units; i++) {
+		print(priv, "%-48.*s %10llu %10llu %10llu %12llu\n",
+		      unit[i].len, unit[i].name,
+		      unit[i].rd, unit[i].wr, unit[i].mask, unit[i].ns);
+	}
+
+	print(priv, "\n%-8s %10s %10s\n", "page", "rd", "wr");
+	for (i = 0; i < NVKM_MMIO_PAGES; i++) {
+		if (nvkm_mmio_page[i].rd || nvkm_mmio_page[i].wr) {
+			print(priv, "%06x   %10llu %10llu\n", i << 12,
+			      nvkm_mmio_page[i].rd, nvkm_mmio_page[i].wr);
+		}
+	}
+	mutex_unlock(&nvkm_mmio_dump_mutex);
+}
+
+void
+nvkm_mmio_reset(void)
+{
+	struct nvkm_mmio_site *site;
+	unsigned long flags;
+
+	spin_lock_irqsave(&nvkm_mmio_lock, flags);
+	for (site = nvkm_mmio_sites; site; site = site->next)
+		site->rd = site->wr = site->mask = site->ns = 0;
+	memset(nvkm_mmio_page, 0x00, sizeof(nvkm_mmio_page));
+	spin_unlock_irqrestore(&nvkm_mmio_lock, flags);
+}
+#endif
@@ -37,23 +37,44 @@ nvkm_ramht_hash(struct nvkm_ramht *ramht, int chid, u32 handle)
 	return hash;
 }
 
-struct nvkm_gpuobj *
-nvkm_ramht_search(struct nvkm_ramht *ramht, int chid, u32 handle)
+static int
+nvkm_ramht_probe(struct nvkm_ramht *ramht, int co)
 {
-	u32 co, ho;
+	struct nvkm_ramht_data *data = &ramht->data[co];
+	int ho = nvkm_ramht_hash(ramht, data->chid, data->handle);
+	return (co - ho + ramht->size) % ramht->size;
+}
 
-	co = ho = nvkm_ramht_hash(ramht, chid, handle);
-	do {
+static int
+nvkm_ramht_find(struct nvkm_ramht *ramht, int chid, u32 handle)
+{
+	u32 co;
+	int i;
+
+	/* No live entry is further than probe_max from its hash slot,
+	 * so there's no need to walk the rest of the table on a miss.
+	 */
+	co = nvkm_ramht_hash(ramht, chid, handle);
+	for (i = 0; i <= ramht->probe_max; i++) {
 		if (ramht->data[co].chid == chid) {
 			if (ramht->data[co].handle == handle)
-				return ramht->data[co].inst;
+				return co;
 		}
 
 		if (++co >= ramht->size)
 			co = 0;
-	} while (co != ho);
+	}
 
-	return NULL;
+	return -1;
+}
+
+struct nvkm_gpuobj *
+nvkm_ramht_search(struct nvkm_ramht *ramht, int chid, u32 handle)
+{
+	int co = nvkm_ramht_find(ramht, chid, handle);
+	if (co < 0)
+		return NULL;
+	return ramht->data[co].inst;
 }
 
 static int
@@ -99,29 +120,63 @@ nvkm_ramht_update(struct nvkm_ramht *ramht, int co, struct nvkm_object *object,
 void
 nvkm_ramht_remove(struct nvkm_ramht *ramht, int cookie)
 {
-	if (--cookie >= 0)
-		nvkm_ramht_update(ramht, cookie, NULL, -1, 0, 0, 0);
+	int probe, i;
+
+	if (--cookie < 0)
+		return;
+
+	probe = nvkm_ramht_probe(ramht, cookie);
+	nvkm_ramht_update(ramht, cookie, NULL, -1, 0, 0, 0);
+	ramht->probes -= probe;
+	ramht->count--;
+
+	/* Removing the furthest-displaced entry may shrink the bound. */
+	if (probe == ramht->probe_max) {
+		ramht->probe_max = 0;
+		for (i = 0; i < ramht->size; i++) {
+			if (ramht->data[i].chid >= 0) {
+				probe = nvkm_ramht_probe(ramht, i);
+				ramht->probe_max = max(ramht->probe_max, probe);
+			}
+		}
+	}
 }
 
 int
 nvkm_ramht_insert(struct nvkm_ramht *ramht, struct nvkm_object *object,
 		  int chid, int addr, u32 handle, u32 context)
 {
-	u32 co, ho;
+	u32 co;
+	int ret, i;
 
-	if (nvkm_ramht_search(ramht, chid, handle))
+	if (nvkm_ramht_find(ramht, chid, handle) >= 0)
 		return -EEXIST;
 
-	co = ho = nvkm_ramht_hash(ramht, chid, handle);
-	do {
+	co = nvkm_ramht_hash(ramht, chid, handle);
+	for (i = 0; i < ramht->size; i++) {
 		if (ramht->data[co].chid < 0) {
-			return nvkm_ramht_update(ramht, co, object, chid,
-						 addr, handle, context);
+			ret = nvkm_ramht_update(ramht, co, object, chid,
+						addr, handle, context);
+			if (ret < 0)
+				return ret;
+
+			ramht->probes += i;
+			ramht->count++;
+			ramht->count_peak = max(ramht->count_peak, ramht->count);
+			if (i > ramht->probe_max) {
+				ramht->probe_max = i;
+				ramht->probe_peak = max(ramht->probe_peak, i);
+				nvdev_trace(ramht->device, "ramht %d/%d entries, "
+					    "probe bound %d, total probes %llu\n",
+					    ramht->count, ramht->size,
+					    ramht->probe_max, ramht->probes);
+			}
+			return ret;
 		}
 
 		if (++co >= ramht->size)
 			co = 0;
-	} while (co != ho);
+	}
 
 	return -ENOSPC;
 }
@@ -131,6 +186,9 @@ nvkm_ramht_del(struct nvkm_ramht **pramht)
 {
 	struct nvkm_ramht *ramht = *pramht;
 	if (ramht) {
+		nvdev_debug(ramht->device, "ramht peak %d/%d entries, "
+			    "longest probe %d\n", ramht->count_peak,
+			    ramht->size, ramht->probe_peak);
 		nvkm_gpuobj_del(&ramht->gpuobj);
 		vfree(*pramht);
 		*pramht = NULL;
@@ -40,6 +40,8 @@ struct lt_state {
 	bool pc2;
 	u8  pc2stat;
 	u8  pc2conf[2];
+	u8  adj[3];
+	int aux;
 };
 
 static int
@@ -53,11 +55,13 @@ nvkm_dp_train_sense(struct lt_state *lt, bool pc, u32 delay)
 	else
 		udelay(delay);
 
+	lt->aux++;
 	ret = nvkm_rdaux(dp->aux, DPCD_LS02, lt->stat, 6);
 	if (ret)
 		return ret;
 
 	if (pc) {
+		lt->aux++;
 		ret = nvkm_rdaux(dp->aux, DPCD_LS0C, &lt->pc2stat, 1);
 		if (ret)
 			lt->pc2stat = 0x00;
@@ -82,6 +86,11 @@ nvkm_dp_train_drive(struct lt_state *lt, bool pc)
 	u32 data;
 	int ret, i;
 
+	/* Remember what we're applying, in case it trains successfully. */
+	lt->adj[0] = lt->stat[4];
+	lt->adj[1] = lt->stat[5];
+	lt->adj[2] = lt->pc2stat;
+
 	for (i = 0; i < ior->dp.nr; i++) {
 		u8 lane = (lt->stat[4 + (i >> 1)] >> ((i & 1) * 4)) & 0xf;
 		u8 lpc2 = (lt->pc2stat >> (i * 2)) & 0x3;
@@ -123,11 +132,13 @@ nvkm_dp_train_drive(struct lt_state *lt, bool pc)
 					    ocfg.pe, ocfg.tx_pu);
 	}
 
+	lt->aux++;
 	ret = nvkm_wraux(dp->aux, DPCD_LC03(0), lt->conf, 4);
 	if (ret)
 		return ret;
 
 	if (pc) {
+		lt->aux++;
 		ret = nvkm_wraux(dp->aux, DPCD_LC0F, lt->pc2conf, 2);
 		if (ret)
 			return ret;
@@ -149,6 +160,55 @@ nvkm_dp_train_pattern(struct lt_state *lt, u8 pattern)
 	sink_tp &= ~DPCD_LC02_TRAINING_PATTERN_SET;
 	sink_tp |= pattern;
 	nvkm_wraux(dp->aux, DPCD_LC02, &sink_tp, 1);
+	lt->aux += 2;
+}
+
+static bool
+nvkm_dp_train_lanes_ok(struct lt_state *lt, u8 mask)
+{
+	int i;
+
+	for (i = 0; i < lt->dp->outp.ior->dp.nr; i++) {
+		u8 lane = (lt->stat[i >> 1] >> ((i & 1) * 4)) & 0xf;
+		if ((lane & mask) != mask)
+			return false;
+	}
+
+	return true;
+}
+
+/* Apply the drive settings cached from the last successful training of
+ * this sink/link configuration, and check the link comes up with them,
+ * skipping the clock recovery and equalisation loops entirely.
+ */
+static int
+nvkm_dp_train_fast(struct lt_state *lt)
+{
+	struct nvkm_dp *dp = lt->dp;
+
+	lt->stat[4] = dp->lt.cache.adj[0];
+	lt->stat[5] = dp->lt.cache.adj[1];
+	lt->pc2stat = dp->lt.cache.adj[2];
+
+	nvkm_dp_train_pattern(lt, 1);
+	if (nvkm_dp_train_drive(lt, lt->pc2) ||
+	    nvkm_dp_train_sense(lt, false, 100) ||
+	    !nvkm_dp_train_lanes_ok(lt, DPCD_LS02_LANE0_CR_DONE))
+		return -1;
+
+	if (dp->dpcd[DPCD_RC02] & DPCD_RC02_TPS3_SUPPORTED)
+		nvkm_dp_train_pattern(lt, 3);
+	else
+		nvkm_dp_train_pattern(lt, 2);
+
+	if (nvkm_dp_train_sense(lt, lt->pc2, 400) ||
+	    !(lt->stat[2] & DPCD_LS04_INTERLANE_ALIGN_DONE) ||
+	    !nvkm_dp_train_lanes_ok(lt, DPCD_LS02_LANE0_CR_DONE |
+					DPCD_LS02_LANE0_CHANNEL_EQ_DONE |
+					DPCD_LS02_LANE0_SYMBOL_LOCKED))
+		return -1;
+
+	return 0;
 }
 
 static int
@@ -278,12 +338,38 @@ nvkm_dp_train_links(struct nvkm_dp *dp)
 	if (ret)
 		return ret;
 
+	/* Try the settings that worked last time, if there were any. */
+	ret = -1;
+	if (dp->lt.cache.valid &&
+	    dp->lt.cache.bw == ior->dp.bw && dp->lt.cache.nr == ior->dp.nr &&
+	    !memcmp(dp->lt.cache.dpcd, dp->dpcd, sizeof(dp->dpcd))) {
+		memset(lt.stat, 0x00, sizeof(lt.stat));
+		ret = nvkm_dp_train_fast(&lt);
+		OUTP_DBG(&dp->outp, "fast retrain %s (%d aux)",
+			 ret ? "failed" : "done", lt.aux);
+		dp->lt.cache.valid = false;
+	}
+
 	/* Attempt to train the link in this configuration. */
-	memset(lt.stat, 0x00, sizeof(lt.stat));
-	ret = nvkm_dp_train_cr(&lt);
-	if (ret == 0)
-		ret = nvkm_dp_train_eq(&lt);
+	if (ret) {
+		memset(lt.stat, 0x00, sizeof(lt.stat));
+		memset(lt.pc2conf, 0x00, sizeof(lt.pc2conf));
+		lt.pc2stat = 0x00;
+		ret = nvkm_dp_train_cr(&lt);
+		if (ret == 0)
+			ret = nvkm_dp_train_eq(&lt);
+	}
 	nvkm_dp_train_pattern(&lt, 0);
+
+	if (ret == 0) {
+		memcpy(dp->lt.cache.dpcd, dp->dpcd, sizeof(dp->dpcd));
+		memcpy(dp->lt.cache.adj, lt.adj, sizeof(lt.adj));
+		dp->lt.cache.bw = ior->dp.bw;
+		dp->lt.cache.nr = ior->dp.nr;
+		dp->lt.cache.valid = true;
+	}
+
+	OUTP_DBG(&dp->outp, "%d aux transactions", lt.aux);
 	return ret;
 }
 
@@ -351,6 +437,7 @@ nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 	const u8 outp_bw = dp->outp.info.dpconf.link_bw;
 	const struct dp_rates *failsafe = NULL, *cfg;
 	int ret = -EINVAL;
+	s64 time;
 	u8  pwr;
 
 	/* Find the lowest configuration of the OR that can support
@@ -393,6 +480,7 @@ nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 	/* Link training. */
 	OUTP_DBG(&dp->outp, "training (min: %d x %d MB/s)",
 		 failsafe->nr, failsafe->bw * 27);
+	time = ktime_to_us(ktime_get());
 	nvkm_dp_train_init(dp);
 	for (cfg = nvkm_dp_rates; ret < 0 && cfg <= failsafe; cfg++) {
 		/* Skip configurations not supported by both OR and sink. */
@@ -411,10 +499,11 @@ nvkm_dp_train(struct nvkm_dp *dp, u32 dataKBps)
 		ret = nvkm_dp_train_links(dp);
 	}
 	nvkm_dp_train_fini(dp);
+	time = ktime_to_us(ktime_get()) - time;
 	if (ret < 0)
 		OUTP_ERR(&dp->outp, "training failed");
 	else
-		OUTP_DBG(&dp->outp, "training done");
+		OUTP_DBG(&dp->outp, "training done in %lld us", time);
 	atomic_set(&dp->lt.done, 1);
 	return ret;
 }
@@ -27,6 +27,17 @@ struct nvkm_dp {
 	struct {
 		atomic_t done;
 		bool mst;
+
+		/* Drive settings of the last successful training, reused
+		 * for the same sink (by DPCD caps) and link configuration.
+		 */
+		struct {
+			bool valid;
+			u8 dpcd[16];
+			u8 bw;
+			u8 nr;
+			u8 adj[3];
+		} cache;
 	} lt;
 };
 
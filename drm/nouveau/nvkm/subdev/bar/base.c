@@ -26,8 +26,24 @@
 void
 nvkm_bar_flush(struct nvkm_bar *bar)
 {
-	if (bar && bar->func->flush)
+	unsigned long flags;
+	u32 gen;
+
+	if (!bar || !bar->func->flush)
+		return;
+
+	gen = atomic_inc_return(&bar->flush.gen);
+
+	spin_lock_irqsave(&bar->lock, flags);
+	if ((s32)(bar->flush.done - gen) >= 0) {
+		bar->flush.elided++;
+	} else {
+		gen = atomic_read(&bar->flush.gen);
 		bar->func->flush(bar);
+		bar->flush.done = gen;
+		bar->flush.issued++;
+	}
+	spin_unlock_irqrestore(&bar->lock, flags);
 }
 
 struct nvkm_vmm *
@@ -95,6 +111,8 @@ nvkm_bar_fini(struct nvkm_subdev *subdev, bool suspend)
 	struct nvkm_bar *bar = nvkm_bar(subdev);
 	if (bar->func->bar1.fini)
 		bar->func->bar1.fini(bar);
+	nvkm_debug(subdev, "flush: %llu issued, %llu elided\n",
+		   bar->flush.issued, bar->flush.elided);
 	return 0;
 }
 
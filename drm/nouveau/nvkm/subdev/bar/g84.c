@@ -29,14 +29,11 @@ void
 g84_bar_flush(struct nvkm_bar *bar)
 {
 	struct nvkm_device *device = bar->subdev.device;
-	unsigned long flags;
-	spin_lock_irqsave(&bar->lock, flags);
 	nvkm_wr32(device, 0x070000, 0x00000001);
 	nvkm_msec(device, 2000,
 		if (!(nvkm_rd32(device, 0x070000) & 0x00000002))
 			break;
 	);
-	spin_unlock_irqrestore(&bar->lock, flags);
 }
 
 static const struct nvkm_bar_func
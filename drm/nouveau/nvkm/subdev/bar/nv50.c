@@ -31,16 +31,12 @@
 static void
 nv50_bar_flush(struct nvkm_bar *base)
 {
-	struct nv50_bar *bar = nv50_bar(base);
-	struct nvkm_device *device = bar->base.subdev.device;
-	unsigned long flags;
-	spin_lock_irqsave(&bar->base.lock, flags);
+	struct nvkm_device *device = base->subdev.device;
 	nvkm_wr32(device, 0x00330c, 0x00000001);
 	nvkm_msec(device, 2000,
 		if (!(nvkm_rd32(device, 0x00330c) & 0x00000002))
 			break;
 	);
-	spin_unlock_irqrestore(&bar->base.lock, flags);
 }
 
 struct nvkm_vmm *
@@ -19,6 +19,7 @@ struct nvkm_bar_func {
 		struct nvkm_vmm *(*vmm)(struct nvkm_bar *);
 	} bar1, bar2;
 
+	/* Called with nvkm_bar.lock held. */
 	void (*flush)(struct nvkm_bar *);
 };
 
@@ -230,7 +230,7 @@ nvkm_i2c_bus_ctor(const struct nvkm_i2c_bus_func *func,
 	bus->i2c.owner = THIS_MODULE;
 	bus->i2c.dev.parent = device->dev;
 
-	if ( bus->func->drive_scl &&
+	if ( bus->func->drive_scl && bus->func->xfer == nvkm_i2c_bit_xfer &&
 	    !nvkm_boolopt(device->cfgopt, "NvI2C", internal)) {
 		if (!(bit = kzalloc(sizeof(*bit), GFP_KERNEL)))
 			return -ENOMEM;
@@ -24,9 +24,17 @@
 #define gf119_i2c_bus(p) container_of((p), struct gf119_i2c_bus, base)
 #include "bus.h"
 
+#include <core/option.h>
+#include <subdev/timer.h>
+
 struct gf119_i2c_bus {
 	struct nvkm_i2c_bus base;
 	u32 addr;
+	u32 ctrl;
+
+	/* hw controller vs. bit-banging statistics, for tuning. */
+	u32 hw_xfers;
+	u32 bit_xfers;
 };
 
 static void
@@ -69,6 +77,152 @@ gf119_i2c_bus_init(struct nvkm_i2c_bus *base)
 	nvkm_wr32(device, bus->addr, 0x00000007);
 }
 
+/*******************************************************************************
+ * Hardware I2C controller
+ *
+ * Each port has a small controller (ADDR/DATA/CNTL at +0x00/+0x04/+0x08
+ * from the port base, the bit-banging override lives at +0x14) that can
+ * shift up to 4 bytes per cycle, generating START/STOP and checking ACKs
+ * itself.  We use it for whole messages, and fall back to bit-banging if
+ * the controller fails before completing any cycle.  Once the target has
+ * seen part of the transfer, resending it (ie. an EEPROM write) isn't
+ * safe, so the error is returned instead.
+ ******************************************************************************/
+static int
+gf119_i2c_bus_hw_wait(struct gf119_i2c_bus *bus, u32 *cntl)
+{
+	struct nvkm_device *device = bus->base.pad->i2c->subdev.device;
+
+	if (nvkm_usec(device, 2200,
+		*cntl = nvkm_rd32(device, bus->ctrl + 0x08);
+		if (!(*cntl & 0x80000000))
+			break;
+		NVKM_DELAY;
+	) < 0)
+		return -ETIMEDOUT;
+
+	switch ((*cntl & 0x0f000000) >> 24) {
+	case 0: return 0;	/* OKAY */
+	case 1: return -ENXIO;	/* NO_ACK */
+	case 4: return -ETIMEDOUT;
+	default:
+		return -EIO;
+	}
+}
+
+static int
+gf119_i2c_bus_hw_cycle(struct gf119_i2c_bus *bus, struct i2c_msg *msg,
+		       int pos, bool start, bool stop)
+{
+	struct nvkm_device *device = bus->base.pad->i2c->subdev.device;
+	const bool rd = !!(msg->flags & I2C_M_RD);
+	const int size = min_t(int, msg->len - pos, 4);
+	u32 cntl, data = 0;
+	int ret, i;
+
+	cntl  = rd ? 0x00000002 : 0x00000001;
+	cntl |= size << 4;
+	if (start)
+		cntl |= 0x00000004;
+	if (stop)
+		cntl |= 0x00000008;
+
+	if (!rd) {
+		for (i = 0; i < size; i++)
+			data |= msg->buf[pos + i] << (i * 8);
+		nvkm_wr32(device, bus->ctrl + 0x04, data);
+	}
+
+	nvkm_wr32(device, bus->ctrl + 0x08, 0x80000000 | cntl);
+	ret = gf119_i2c_bus_hw_wait(bus, &cntl);
+	BUS_TRACE(&bus->base, "hw %02x %s %d/%d %08x %d", msg->addr,
+		  rd ? "rd" : "wr", pos, msg->len, cntl, ret);
+	if (ret)
+		return ret;
+
+	if (rd) {
+		data = nvkm_rd32(device, bus->ctrl + 0x04);
+		for (i = 0; i < size; i++)
+			msg->buf[pos + i] = data >> (i * 8);
+	}
+
+	return 0;
+}
+
+static int
+gf119_i2c_bus_hw_xfer(struct gf119_i2c_bus *bus, struct i2c_msg *msgs, int num,
+		      bool *sent)
+{
+	struct nvkm_device *device = bus->base.pad->i2c->subdev.device;
+	int ret = 0, m, pos;
+
+	for (m = 0; m < num; m++) {
+		if (msgs[m].flags & (I2C_M_TEN | I2C_M_RECV_LEN))
+			return -EINVAL;
+	}
+
+	/* Hand the pads over to the controller. */
+	nvkm_mask(device, bus->addr, 0x00000004, 0x00000000);
+
+	for (m = 0; !ret && m < num; m++) {
+		struct i2c_msg *msg = &msgs[m];
+
+		nvkm_wr32(device, bus->ctrl + 0x00, msg->addr << 1);
+		pos = 0;
+		do {
+			const bool last = pos + 4 >= msg->len;
+			ret = gf119_i2c_bus_hw_cycle(bus, msg, pos, pos == 0,
+						     last && m == num - 1);
+			if (ret == 0)
+				*sent = true;
+			pos += 4;
+		} while (!ret && pos < msg->len);
+	}
+
+	if (ret) {
+		/* Reset the controller, terminating any partial cycle. */
+		nvkm_wr32(device, bus->ctrl + 0x08, 0x00000000);
+	}
+
+	nvkm_wr32(device, bus->addr, 0x00000007);
+	return ret;
+}
+
+static int
+gf119_i2c_bus_xfer(struct nvkm_i2c_bus *base, struct i2c_msg *msgs, int num)
+{
+	struct gf119_i2c_bus *bus = gf119_i2c_bus(base);
+	bool sent = false;
+	int ret;
+
+	ret = gf119_i2c_bus_hw_xfer(bus, msgs, num, &sent);
+	if (ret == 0) {
+		bus->hw_xfers++;
+		return num;
+	}
+
+	/* A missing device is a valid answer, don't retry it, and neither
+	 * retry anything the target has already (partially) received.
+	 */
+	if (ret == -ENXIO || sent)
+		return ret;
+
+	bus->bit_xfers++;
+	BUS_DBG(&bus->base, "hw xfer failed (%d), bit-banging (hw %u bit %u)",
+		ret, bus->hw_xfers, bus->bit_xfers);
+	return nvkm_i2c_bit_xfer(&bus->base, msgs, num);
+}
+
+static const struct nvkm_i2c_bus_func
+gf119_i2c_bus_hw_func = {
+	.init = gf119_i2c_bus_init,
+	.drive_scl = gf119_i2c_bus_drive_scl,
+	.drive_sda = gf119_i2c_bus_drive_sda,
+	.sense_scl = gf119_i2c_bus_sense_scl,
+	.sense_sda = gf119_i2c_bus_sense_sda,
+	.xfer = gf119_i2c_bus_xfer,
+};
+
 static const struct nvkm_i2c_bus_func
 gf119_i2c_bus_func = {
 	.init = gf119_i2c_bus_init,
@@ -83,13 +237,19 @@ int
 gf119_i2c_bus_new(struct nvkm_i2c_pad *pad, int id, u8 drive,
 		 struct nvkm_i2c_bus **pbus)
 {
+	struct nvkm_device *device = pad->i2c->subdev.device;
+	const struct nvkm_i2c_bus_func *func = &gf119_i2c_bus_func;
 	struct gf119_i2c_bus *bus;
 
 	if (!(bus = kzalloc(sizeof(*bus), GFP_KERNEL)))
 		return -ENOMEM;
 	*pbus = &bus->base;
 
-	nvkm_i2c_bus_ctor(&gf119_i2c_bus_func, pad, id, &bus->base);
-	bus->addr = 0x00d014 + (drive * 0x20);
+	if (nvkm_boolopt(device->cfgopt, "NvI2CHw", false))
+		func = &gf119_i2c_bus_hw_func;
+
+	nvkm_i2c_bus_ctor(func, pad, id, &bus->base);
+	bus->ctrl = 0x00d000 + (drive * 0x20);
+	bus->addr = bus->ctrl + 0x14;
 	return 0;
 }
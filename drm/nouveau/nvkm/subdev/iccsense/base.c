@@ -23,11 +23,13 @@
  */
 #include "priv.h"
 
+#include <core/option.h>
 #include <subdev/bios.h>
 #include <subdev/bios/extdev.h>
 #include <subdev/bios/iccsense.h>
 #include <subdev/bios/power_budget.h>
 #include <subdev/i2c.h>
+#include <subdev/timer.h>
 
 static bool
 nvkm_iccsense_validate_device(struct i2c_adapter *i2c, u8 addr,
@@ -46,15 +48,12 @@ nvkm_iccsense_validate_device(struct i2c_adapter *i2c, u8 addr,
 }
 
 static int
-nvkm_iccsense_poll_lane(struct i2c_adapter *i2c, u8 addr, u8 shunt_reg,
+nvkm_iccsense_poll_lane(struct nvkm_iccsense_sensor *sensor, u8 shunt_reg,
 			u8 shunt_shift, u8 bus_reg, u8 bus_shift, u8 shunt,
 			u16 lsb)
 {
-	int vshunt = nv_rd16i2cr(i2c, addr, shunt_reg);
-	int vbus = nv_rd16i2cr(i2c, addr, bus_reg);
-
-	if (vshunt < 0 || vbus < 0)
-		return -EINVAL;
+	int vshunt = sensor->reg[shunt_reg];
+	int vbus = sensor->reg[bus_reg];
 
 	vshunt >>= shunt_shift;
 	vbus >>= bus_shift;
@@ -67,9 +66,8 @@ nvkm_iccsense_ina2x9_read(struct nvkm_iccsense *iccsense,
                           struct nvkm_iccsense_rail *rail,
 			  u8 shunt_reg, u8 bus_reg)
 {
-	return nvkm_iccsense_poll_lane(rail->sensor->i2c, rail->sensor->addr,
-				       shunt_reg, 0, bus_reg, 3, rail->mohm,
-				       10 * 4);
+	return nvkm_iccsense_poll_lane(rail->sensor, shunt_reg, 0, bus_reg, 3,
+				       rail->mohm, 10 * 4);
 }
 
 static int
@@ -90,12 +88,87 @@ static int
 nvkm_iccsense_ina3221_read(struct nvkm_iccsense *iccsense,
 			   struct nvkm_iccsense_rail *rail)
 {
-	return nvkm_iccsense_poll_lane(rail->sensor->i2c, rail->sensor->addr,
-				       1 + (rail->idx * 2), 3,
+	return nvkm_iccsense_poll_lane(rail->sensor, 1 + (rail->idx * 2), 3,
 				       2 + (rail->idx * 2), 3, rail->mohm,
 				       40 * 8);
 }
 
+/* Fetch every measurement register of a sensor in a single i2c transfer,
+ * the INA parts don't auto-increment the register pointer, so each read
+ * is preceded by a pointer write, with repeated STARTs in between.
+ */
+static int
+nvkm_iccsense_sensor_sample(struct nvkm_iccsense *iccsense,
+			    struct nvkm_iccsense_sensor *sensor)
+{
+	struct i2c_msg msgs[12];
+	u8 regs[6], data[6][2];
+	int base, nr, i;
+
+	switch (sensor->type) {
+	case NVBIOS_EXTDEV_INA209 : base = 3; nr = 2; break;
+	case NVBIOS_EXTDEV_INA219 : base = 1; nr = 2; break;
+	case NVBIOS_EXTDEV_INA3221: base = 1; nr = 6; break;
+	default:
+		return -ENODEV;
+	}
+
+	for (i = 0; i < nr; i++) {
+		regs[i] = base + i;
+		msgs[i * 2 + 0] = (struct i2c_msg) {
+			.addr = sensor->addr, .flags = 0,
+			.len = 1, .buf = &regs[i],
+		};
+		msgs[i * 2 + 1] = (struct i2c_msg) {
+			.addr = sensor->addr, .flags = I2C_M_RD,
+			.len = 2, .buf = data[i],
+		};
+	}
+
+	iccsense->stat.xfers++;
+	if (i2c_transfer(sensor->i2c, msgs, nr * 2) != nr * 2)
+		return -EIO;
+
+	for (i = 0; i < nr; i++)
+		sensor->reg[base + i] = (data[i][0] << 8) | data[i][1];
+	return 0;
+}
+
+/* Time (in us) for the sensor to produce a fresh set of samples, given
+ * its configured conversion times, averaging and enabled channels.
+ */
+static u32
+nvkm_iccsense_sensor_period(struct nvkm_iccsense_sensor *sensor)
+{
+	static const u32 ina2x9_ct[] = {
+		84, 148, 276, 532, 84, 148, 276, 532,
+		532, 1060, 2130, 4260, 8510, 17020, 34050, 68100
+	};
+	static const u16 ina3221_ct[] = {
+		140, 204, 332, 588, 1100, 2116, 4156, 8244
+	};
+	static const u16 ina3221_avg[] = {
+		1, 4, 16, 64, 128, 256, 512, 1024
+	};
+	const u16 cfg = sensor->config;
+	u32 adc[2];
+
+	switch (sensor->type) {
+	case NVBIOS_EXTDEV_INA209:
+	case NVBIOS_EXTDEV_INA219:
+		adc[0] = ina2x9_ct[(cfg & 0x0780) >> 7];
+		adc[1] = ina2x9_ct[(cfg & 0x0078) >> 3];
+		return adc[0] + adc[1];
+	case NVBIOS_EXTDEV_INA3221:
+		return (ina3221_ct[(cfg & 0x01c0) >> 6] +
+			ina3221_ct[(cfg & 0x0038) >> 3]) *
+			ina3221_avg[(cfg & 0x0e00) >> 9] *
+			hweight8((cfg & 0x7000) >> 12);
+	default:
+		return 0;
+	}
+}
+
 static void
 nvkm_iccsense_sensor_config(struct nvkm_iccsense *iccsense,
 		            struct nvkm_iccsense_sensor *sensor)
@@ -103,16 +176,22 @@ nvkm_iccsense_sensor_config(struct nvkm_iccsense *iccsense,
 	struct nvkm_subdev *subdev = &iccsense->subdev;
 	nvkm_trace(subdev, "write config of extdev %i: 0x%04x\n", sensor->id, sensor->config);
 	nv_wr16i2cr(sensor->i2c, sensor->addr, 0x00, sensor->config);
+	sensor->period = nvkm_iccsense_sensor_period(sensor);
 }
 
-int
-nvkm_iccsense_read_all(struct nvkm_iccsense *iccsense)
+static int
+nvkm_iccsense_sample(struct nvkm_iccsense *iccsense)
 {
-	int result = 0;
+	struct nvkm_iccsense_sensor *sensor;
 	struct nvkm_iccsense_rail *rail;
+	u32 xfers = iccsense->stat.xfers;
+	int result = 0, ret;
 
-	if (!iccsense)
-		return -EINVAL;
+	list_for_each_entry(sensor, &iccsense->sensors, head) {
+		ret = nvkm_iccsense_sensor_sample(iccsense, sensor);
+		if (ret)
+			return ret;
+	}
 
 	list_for_each_entry(rail, &iccsense->rails, head) {
 		int res;
@@ -124,9 +203,44 @@ nvkm_iccsense_read_all(struct nvkm_iccsense *iccsense)
 			return res;
 		result += res;
 	}
+
+	iccsense->stat.sweeps++;
+	nvkm_trace(&iccsense->subdev, "sampled in %d transfers (%d cached)\n",
+		   iccsense->stat.xfers - xfers, iccsense->stat.cached);
 	return result;
 }
 
+int
+nvkm_iccsense_read_all(struct nvkm_iccsense *iccsense)
+{
+	struct nvkm_iccsense_sensor *sensor;
+	u32 max_age;
+	u64 time;
+	int ret;
+
+	if (!iccsense)
+		return -EINVAL;
+
+	mutex_lock(&iccsense->mutex);
+	max_age = iccsense->max_age;
+	list_for_each_entry(sensor, &iccsense->sensors, head)
+		max_age = max(max_age, sensor->period);
+
+	time = nvkm_timer_read(iccsense->subdev.device->timer);
+	if (iccsense->time && time - iccsense->time < max_age * 1000ULL) {
+		iccsense->stat.cached++;
+		ret = iccsense->power;
+	} else {
+		ret = nvkm_iccsense_sample(iccsense);
+		if (ret >= 0) {
+			iccsense->power = ret;
+			iccsense->time = time;
+		}
+	}
+	mutex_unlock(&iccsense->mutex);
+	return ret;
+}
+
 static void *
 nvkm_iccsense_dtor(struct nvkm_subdev *subdev)
 {
@@ -301,6 +415,7 @@ nvkm_iccsense_init(struct nvkm_subdev *subdev)
 	struct nvkm_iccsense_sensor *sensor;
 	list_for_each_entry(sensor, &iccsense->sensors, head)
 		nvkm_iccsense_sensor_config(iccsense, sensor);
+	iccsense->time = 0;
 	return 0;
 }
 
@@ -316,6 +431,9 @@ nvkm_iccsense_ctor(struct nvkm_device *device, int index,
 		   struct nvkm_iccsense *iccsense)
 {
 	nvkm_subdev_ctor(&iccsense_func, device, index, &iccsense->subdev);
+	mutex_init(&iccsense->mutex);
+	iccsense->max_age = nvkm_longopt(device->cfgopt, "NvIccSenseMaxAge",
+					 100) * 1000;
 }
 
 int
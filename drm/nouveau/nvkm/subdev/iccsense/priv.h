@@ -12,6 +12,8 @@ struct nvkm_iccsense_sensor {
 	struct i2c_adapter *i2c;
 	u8 addr;
 	u16 config;
+	u32 period; /* us, from the averaging/conversion-time config */
+	u16 reg[8];
 };
 
 struct nvkm_iccsense_rail {
@@ -24,6 +24,7 @@
 #include "priv.h"
 
 #include <core/memory.h>
+#include <subdev/fb.h>
 
 void
 nvkm_ltc_tags_clear(struct nvkm_device *device, u32 first, u32 count)
@@ -31,14 +32,84 @@ nvkm_ltc_tags_clear(struct nvkm_device *device, u32 first, u32 count)
 	struct nvkm_ltc *ltc = device->ltc;
 	const u32 limit = first + count - 1;
 
+	unsigned long *dirty = ltc->cbc.dirty;
+	u32 lo = first, hi = limit;
+
 	BUG_ON((first > limit) || (limit >= ltc->num_tags));
 
 	mutex_lock(&ltc->subdev.mutex);
-	ltc->func->cbc_clear(ltc, first, limit);
+	if (dirty) {
+		/* Nothing to do if the background worker got here first. */
+		if (find_next_bit(dirty, limit + 1, first) > limit) {
+			ltc->cbc.fast++;
+			mutex_unlock(&ltc->subdev.mutex);
+			return;
+		}
+
+		/* Pick up any adjacent freed tags in the same clear. */
+		while (lo > 0 && test_bit(lo - 1, dirty))
+			lo--;
+		hi = find_next_zero_bit(dirty, ltc->num_tags, limit + 1) - 1;
+	}
+
+	ltc->func->cbc_clear(ltc, lo, hi);
 	ltc->func->cbc_wait(ltc);
+	if (dirty)
+		bitmap_clear(dirty, lo, hi - lo + 1);
+	ltc->cbc.sync++;
+	mutex_unlock(&ltc->subdev.mutex);
+}
+
+void
+nvkm_ltc_tags_free(struct nvkm_device *device, u32 first, u32 count)
+{
+	struct nvkm_ltc *ltc = device->ltc;
+
+	if (!ltc || !ltc->cbc.dirty)
+		return;
+
+	BUG_ON(first + count > ltc->num_tags);
+
+	/* While the subdev is down the tags just stay dirty, init will
+	 * kick the worker again once the hardware is back.
+	 */
+	mutex_lock(&ltc->subdev.mutex);
+	bitmap_set(ltc->cbc.dirty, first, count);
+	if (ltc->cbc.running)
+		schedule_work(&ltc->cbc.work);
 	mutex_unlock(&ltc->subdev.mutex);
 }
 
+static void
+nvkm_ltc_tags_work(struct work_struct *work)
+{
+	struct nvkm_ltc *ltc = container_of(work, typeof(*ltc), cbc.work);
+	u32 lo = 0, hi;
+
+	/* Clear one run of dirty tags at a time, so that allocations
+	 * needing the lock aren't held off behind the whole sweep.
+	 */
+	for (;;) {
+		mutex_lock(&ltc->subdev.mutex);
+		lo = find_next_bit(ltc->cbc.dirty, ltc->num_tags, lo);
+		if (lo >= ltc->num_tags || !ltc->cbc.running) {
+			mutex_unlock(&ltc->subdev.mutex);
+			break;
+		}
+
+		hi = find_next_zero_bit(ltc->cbc.dirty, ltc->num_tags, lo) - 1;
+		ltc->func->cbc_clear(ltc, lo, hi);
+		ltc->func->cbc_wait(ltc);
+		bitmap_clear(ltc->cbc.dirty, lo, hi - lo + 1);
+		ltc->cbc.async += hi - lo + 1;
+		mutex_unlock(&ltc->subdev.mutex);
+		lo = hi + 1;
+	}
+
+	nvkm_trace(&ltc->subdev, "comptags: %llu sync %llu fast %llu async\n",
+		   ltc->cbc.sync, ltc->cbc.fast, ltc->cbc.async);
+}
+
 int
 nvkm_ltc_zbc_color_get(struct nvkm_ltc *ltc, int index, const u32 color[4])
 {
@@ -63,18 +134,40 @@ nvkm_ltc_zbc_stencil_get(struct nvkm_ltc *ltc, int index, const u32 stencil)
 	return index;
 }
 
+static void
+nvkm_ltc_op(struct nvkm_ltc *ltc, struct nvkm_ltc_op *op,
+	    void (*func)(struct nvkm_ltc *))
+{
+	u32 gen = atomic_inc_return(&op->gen);
+
+	/* The hardware ops poll for up to 2s, so requesters that queue up
+	 * behind an in-flight one sleep, and are then normally covered by
+	 * the next operation without having to issue their own.
+	 */
+	mutex_lock(&ltc->lock);
+	if ((s32)(op->done - gen) >= 0) {
+		op->elided++;
+	} else {
+		gen = atomic_read(&op->gen);
+		func(ltc);
+		op->done = gen;
+		op->issued++;
+	}
+	mutex_unlock(&ltc->lock);
+}
+
 void
 nvkm_ltc_invalidate(struct nvkm_ltc *ltc)
 {
 	if (ltc->func->invalidate)
-		ltc->func->invalidate(ltc);
+		nvkm_ltc_op(ltc, &ltc->invalidate, ltc->func->invalidate);
 }
 
 void
 nvkm_ltc_flush(struct nvkm_ltc *ltc)
 {
 	if (ltc->func->flush)
-		ltc->func->flush(ltc);
+		nvkm_ltc_op(ltc, &ltc->flush, ltc->func->flush);
 }
 
 static void
@@ -105,6 +198,57 @@ nvkm_ltc_init(struct nvkm_subdev *subdev)
 	}
 
 	ltc->func->init(ltc);
+
+	if (ltc->cbc.dirty) {
+		mutex_lock(&subdev->mutex);
+		ltc->cbc.running = true;
+		schedule_work(&ltc->cbc.work);
+		mutex_unlock(&subdev->mutex);
+	}
+	return 0;
+}
+
+/* Tag RAM lives in VRAM, which isn't preserved across suspend, so every
+ * tag that's not currently allocated has to be cleared again before it's
+ * handed out.
+ */
+static void
+nvkm_ltc_tags_lost(struct nvkm_ltc *ltc)
+{
+	struct nvkm_fb *fb = ltc->subdev.device->fb;
+	struct nvkm_mm_node *node;
+
+	mutex_lock(&fb->subdev.mutex);
+	mutex_lock(&ltc->subdev.mutex);
+	bitmap_fill(ltc->cbc.dirty, ltc->num_tags);
+	list_for_each_entry(node, &fb->tags.nodes, nl_entry) {
+		if (node->type != NVKM_MM_TYPE_NONE &&
+		    node->type != NVKM_MM_TYPE_HOLE)
+			bitmap_clear(ltc->cbc.dirty, node->offset, node->length);
+	}
+	mutex_unlock(&ltc->subdev.mutex);
+	mutex_unlock(&fb->subdev.mutex);
+}
+
+static int
+nvkm_ltc_fini(struct nvkm_subdev *subdev, bool suspend)
+{
+	struct nvkm_ltc *ltc = nvkm_ltc(subdev);
+
+	/* Anything still dirty is picked up again by init. */
+	if (ltc->cbc.dirty) {
+		mutex_lock(&subdev->mutex);
+		ltc->cbc.running = false;
+		mutex_unlock(&subdev->mutex);
+		cancel_work_sync(&ltc->cbc.work);
+		if (suspend)
+			nvkm_ltc_tags_lost(ltc);
+	}
+
+	nvkm_debug(subdev, "flush: %llu issued, %llu elided, "
+			   "invalidate: %llu issued, %llu elided\n",
+		   ltc->flush.issued, ltc->flush.elided,
+		   ltc->invalidate.issued, ltc->invalidate.elided);
 	return 0;
 }
 
@@ -112,7 +256,9 @@ static void *
 nvkm_ltc_dtor(struct nvkm_subdev *subdev)
 {
 	struct nvkm_ltc *ltc = nvkm_ltc(subdev);
+	cancel_work_sync(&ltc->cbc.work);
 	nvkm_memory_unref(&ltc->tag_ram);
+	kvfree(ltc->cbc.dirty);
 	return ltc;
 }
 
@@ -121,6 +267,7 @@ nvkm_ltc = {
 	.dtor = nvkm_ltc_dtor,
 	.oneinit = nvkm_ltc_oneinit,
 	.init = nvkm_ltc_init,
+	.fini = nvkm_ltc_fini,
 	.intr = nvkm_ltc_intr,
 };
 
@@ -135,7 +282,9 @@ nvkm_ltc_new_(const struct nvkm_ltc_func *func, struct nvkm_device *device,
 
 	nvkm_subdev_ctor(&nvkm_ltc, device, index, &ltc->subdev);
 	ltc->func = func;
+	mutex_init(&ltc->lock);
 	ltc->zbc_min = 1; /* reserve 0 for disabled */
 	ltc->zbc_max = min(func->zbc, NVKM_LTC_MAX_ZBC_CNT) - 1;
+	INIT_WORK(&ltc->cbc.work, nvkm_ltc_tags_work);
 	return 0;
 }
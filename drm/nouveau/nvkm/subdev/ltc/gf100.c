@@ -197,6 +197,19 @@ gf100_ltc_oneinit_tag_ram(struct nvkm_ltc *ltc)
 		do_div(tag_base, tag_align);
 
 		ltc->tag_base = tag_base;
+
+		/* Tag RAM contents are undefined until cleared. */
+		ltc->cbc.dirty = kvcalloc(BITS_TO_LONGS(ltc->num_tags),
+					  sizeof(*ltc->cbc.dirty), GFP_KERNEL);
+		if (!ltc->cbc.dirty) {
+			/* Without the bitmap, tags_clear() clears every
+			 * allocation inline, which is slow but correct.
+			 */
+			nvkm_warn(&ltc->subdev, "comptags: no dirty map, "
+				  "clearing synchronously\n");
+		} else {
+			bitmap_fill(ltc->cbc.dirty, ltc->num_tags);
+		}
 	}
 
 mm_init:
@@ -112,6 +112,28 @@ struct drm_nouveau_gem_pushbuf {
 	__u32 suffix1;
 	__u64 vram_available;
 	__u64 gart_available;
+	__u32 bolist; /* buffer list id, used in place of buffers */
+	__u32 flags;
+};
+
+/* Submit without relocations, using the buffers' VM addresses directly.
+ * nr_relocs must be 0, presumed offsets are ignored, and buffers that are
+ * already mapped in one of their valid domains are left where they are.
+ * Only available with a per-client VM.
+ */
+#define NOUVEAU_GEM_PUSHBUF_NO_RELOC                                 0x00000001
+
+/* A buffer list registers a pushbuf validation list once, to be used by
+ * id in later submissions.  Only available with a per-client VM.
+ */
+#define NOUVEAU_GEM_BOLIST_NEW                                       0x00000000
+#define NOUVEAU_GEM_BOLIST_DEL                                       0x00000001
+struct drm_nouveau_gem_bolist {
+	__u32 op;
+	__u32 id;
+	__u32 nr_buffers;
+	__u32 pad;
+	__u64 buffers;
 };
 
 #define NOUVEAU_GEM_CPU_PREP_NOWAIT                                  0x00000001
@@ -140,6 +162,7 @@ struct drm_nouveau_gem_cpu_fini {
 #define DRM_NOUVEAU_GEM_CPU_PREP       0x42
 #define DRM_NOUVEAU_GEM_CPU_FINI       0x43
 #define DRM_NOUVEAU_GEM_INFO           0x44
+#define DRM_NOUVEAU_GEM_BOLIST         0x45
 
 struct drm_nouveau_svm_init {
 	__u64 unmanaged_addr;
@@ -195,6 +218,7 @@ struct drm_nouveau_svm_bind {
 #define DRM_IOCTL_NOUVEAU_GEM_CPU_PREP       DRM_IOW (DRM_COMMAND_BASE + DRM_NOUVEAU_GEM_CPU_PREP, struct drm_nouveau_gem_cpu_prep)
 #define DRM_IOCTL_NOUVEAU_GEM_CPU_FINI       DRM_IOW (DRM_COMMAND_BASE + DRM_NOUVEAU_GEM_CPU_FINI, struct drm_nouveau_gem_cpu_fini)
 #define DRM_IOCTL_NOUVEAU_GEM_INFO           DRM_IOWR(DRM_COMMAND_BASE + DRM_NOUVEAU_GEM_INFO, struct drm_nouveau_gem_info)
+#define DRM_IOCTL_NOUVEAU_GEM_BOLIST         DRM_IOWR(DRM_COMMAND_BASE + DRM_NOUVEAU_GEM_BOLIST, struct drm_nouveau_gem_bolist)
 
 #if defined(__cplusplus)
 }
@@ -212,4 +212,5 @@ nvif_driver_drm = {
 	.map = drm_client_map,
 	.unmap = drm_client_unmap,
 	.keep = true,
+	/* No automap, drm_client_map() can't map anything. */
 };
@@ -337,6 +337,17 @@ find_next_bit(const volatile unsigned long *addr, int bits, int bit)
 	return bit;
 }
 
+static inline long
+find_next_zero_bit(const volatile unsigned long *addr, int bits, int bit)
+{
+	while (bit < bits) {
+		if (!test_bit(bit, addr))
+			break;
+		bit++;
+	}
+	return bit;
+}
+
 static inline long
 find_first_zero_bit(volatile unsigned long *addr, int bits)
 {
@@ -356,6 +367,13 @@ bitmap_fill(unsigned long *addr, unsigned int bits)
 		__set_bit(bit, addr);
 }
 
+static inline void
+bitmap_set(unsigned long *addr, unsigned int pos, unsigned int bits)
+{
+	while (bits--)
+		__set_bit(pos++, addr);
+}
+
 static inline void
 bitmap_clear(unsigned long *addr, unsigned int pos, unsigned int bits)
 {
@@ -729,6 +747,29 @@ typedef struct rwlock_t {
 #define write_lock_irq(a) pthread_rwlock_wrlock(&(a)->lock)
 #define write_unlock_irq(a) pthread_rwlock_unlock(&(a)->lock)
 
+/******************************************************************************
+ * rw semaphores
+ *****************************************************************************/
+struct rw_semaphore {
+	pthread_rwlock_t lock;
+};
+
+/* glibc rwlocks prefer readers by default, which would let a stream of
+ * readers starve writers forever, unlike the kernel's rwsem.
+ */
+#define init_rwsem(a) do {                                                     \
+	pthread_rwlockattr_t __attr;                                           \
+	pthread_rwlockattr_init(&__attr);                                      \
+	pthread_rwlockattr_setkind_np(&__attr,                                 \
+			PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);         \
+	pthread_rwlock_init(&(a)->lock, &__attr);                              \
+	pthread_rwlockattr_destroy(&__attr);                                   \
+} while(0)
+#define down_read(a) pthread_rwlock_rdlock(&(a)->lock)
+#define up_read(a) pthread_rwlock_unlock(&(a)->lock)
+#define down_write(a) pthread_rwlock_wrlock(&(a)->lock)
+#define up_write(a) pthread_rwlock_unlock(&(a)->lock)
+
 /******************************************************************************
  * mutexes
  *****************************************************************************/
@@ -1361,6 +1402,7 @@ struct work_struct {
 #define INIT_WORK(a,b) ((a)->func = (b), (a)->nvos = NULL)
 #define schedule_work(a) BUG_ON(!nvos_work_init((a)->exec, (a), &(a)->nvos))
 #define flush_work(a) nvos_work_fini(&(a)->nvos)
+#define cancel_work_sync(a) nvos_work_fini(&(a)->nvos)
 
 bool nvos_work_init(void (*)(void *), void *, struct nvos_work **);
 void nvos_work_fini(struct nvos_work **);
@@ -1460,6 +1502,8 @@ struct i2c_adapter {
 };
 
 #define I2C_M_RD 1
+#define I2C_M_TEN 0x0010
+#define I2C_M_RECV_LEN 0x0400
 
 struct i2c_msg {
 	u16 addr;
@@ -0,0 +1,628 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#define _GNU_SOURCE /* memfd_create(), accept4() */
+#include "priv.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <nvif/driver.h>
+#include <nvif/notify.h>
+#include <nvif/unpack.h>
+#include <nvif/event.h>
+#include <nvif/ioctl.h>
+
+#include <core/client.h>
+#include <core/ioctl.h>
+
+/* A single daemon process owns the devices, and serves nvif clients over
+ * a unix socket.  Each connection shares a memfd with the daemon, which
+ * carries ioctl arguments in both directions along with the notify ring.
+ * The socket itself carries only small fixed-size requests and replies,
+ * and file descriptors: the shared memory and notify eventfd on connect,
+ * and a BAR resource file for each mapping.
+ */
+#define NVOS_IPC_PATH "/run/nvkm.sock"
+#define NVOS_IPC_DATA 0x10000 /* largest ioctl */
+
+struct nvos_ipc_shm {
+	struct {
+		char name[32];
+		char cfg[1024];
+		char dbg[1024];
+	} init;
+	u8 data[NVOS_IPC_DATA];
+	struct nvos_ring_buf ntfy;
+};
+
+enum nvos_ipc_type {
+	NVOS_IPC_INIT,
+	NVOS_IPC_IOCTL,
+	NVOS_IPC_MAP,
+	NVOS_IPC_SUSPEND,
+	NVOS_IPC_RESUME,
+};
+
+struct nvos_ipc_msg {
+	u32 type;
+	s32 ret;
+	u64 addr; /* INIT: device, IOCTL: supervisor, MAP: handle/offset */
+	u64 size;
+};
+
+static const char *
+nvos_ipc_path(void)
+{
+	const char *path = getenv("NVKM_SOCKET");
+	return path ? path : NVOS_IPC_PATH;
+}
+
+static int
+nvos_ipc_send(int sock, struct nvos_ipc_msg *msg, const int *fds, int nr)
+{
+	char cbuf[CMSG_SPACE(sizeof(int) * 2)] = {};
+	struct iovec iov = { .iov_base = msg, .iov_len = sizeof(*msg) };
+	struct msghdr hdr = { .msg_iov = &iov, .msg_iovlen = 1 };
+	struct cmsghdr *cmsg;
+
+	if (WARN_ON(nr > 2))
+		return -EINVAL;
+
+	if (nr) {
+		hdr.msg_control = cbuf;
+		hdr.msg_controllen = CMSG_SPACE(sizeof(int) * nr);
+		cmsg = CMSG_FIRSTHDR(&hdr);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nr);
+		memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nr);
+	}
+
+	if (sendmsg(sock, &hdr, MSG_NOSIGNAL) != sizeof(*msg))
+		return -ECONNRESET;
+	return 0;
+}
+
+static int
+nvos_ipc_recv(int sock, struct nvos_ipc_msg *msg, int *fds, int nr)
+{
+	char cbuf[CMSG_SPACE(sizeof(int) * 2)];
+	struct iovec iov = { .iov_base = msg, .iov_len = sizeof(*msg) };
+	struct msghdr hdr = {
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = cbuf,
+		.msg_controllen = sizeof(cbuf),
+	};
+	struct cmsghdr *cmsg;
+	int i, cnt, *cfd;
+
+	for (i = 0; i < nr; i++)
+		fds[i] = -1;
+
+	if (recvmsg(sock, &hdr, MSG_CMSG_CLOEXEC) != sizeof(*msg))
+		return -ECONNRESET;
+
+	for (cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+		if (cmsg->cmsg_level != SOL_SOCKET ||
+		    cmsg->cmsg_type != SCM_RIGHTS)
+			continue;
+
+		cnt = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+		cfd = (int *)CMSG_DATA(cmsg);
+		for (i = 0; i < cnt; i++) {
+			if (i < nr)
+				fds[i] = cfd[i];
+			else
+				close(cfd[i]);
+		}
+	}
+
+	return 0;
+}
+
+/******************************************************************************
+ * daemon
+ *****************************************************************************/
+struct nvos_ipc_conn {
+	int sock;
+	int efd;
+	struct nvos_ipc_shm *shm;
+	struct nvkm_client *client;
+	bool ref;
+	u8 route;
+	u8 data[NVOS_IPC_DATA]; /* private copy of ioctl arguments */
+};
+
+/* Notifications carry the connection they belong to in their route, which
+ * is replaced when the notify is created, and restored on delivery.  The
+ * mutex also serialises producers on each connection's ring.
+ */
+static DEFINE_MUTEX(nvos_ipc_mutex);
+static struct nvos_ipc_conn *nvos_ipc_conn[256];
+
+static int
+nvos_ipc_ntfy(const void *header, u32 length, const void *data, u32 size)
+{
+	const union {
+		struct nvif_notify_rep_v0 v0;
+	} *args = header;
+	struct nvif_notify_rep_v0 rep;
+	struct nvos_ipc_conn *conn;
+	int ret = NVIF_NOTIFY_DROP;
+
+	if (length != sizeof(args->v0) || args->v0.version != 0) {
+		WARN_ON(1);
+		return NVIF_NOTIFY_DROP;
+	}
+
+	rep = args->v0;
+	rep.route = NVIF_NOTIFY_V0_ROUTE_NVIF;
+
+	mutex_lock(&nvos_ipc_mutex);
+	if ((conn = nvos_ipc_conn[args->v0.route])) {
+		/* As with the local ring, the client re-arms the notify. */
+		if (nvos_ring_push(&conn->shm->ntfy, conn->efd, &rep,
+				   sizeof(rep), data, size) < 0)
+			ret = NVIF_NOTIFY_KEEP;
+	}
+	mutex_unlock(&nvos_ipc_mutex);
+	return ret;
+}
+
+/* The client can still write to the shared memory while nvkm is looking
+ * at the arguments, so they're copied out before being validated.
+ */
+static int
+nvos_ipc_conn_ioctl(struct nvos_ipc_conn *conn, bool super, u32 argc)
+{
+	void *data = conn->data;
+	u32 size = argc;
+	union {
+		struct nvif_ioctl_v0 v0;
+	} *args = data;
+	union {
+		struct nvif_ioctl_ntfy_new_v0 v0;
+	} *ntfy;
+	union {
+		struct nvif_notify_req_v0 v0;
+	} *req = NULL;
+	void *hack = NULL;
+	u8 route = 0;
+	int ret;
+
+	if (!conn->client)
+		return -ENODEV;
+	if (argc > sizeof(conn->data))
+		return -E2BIG;
+
+	memcpy(conn->data, conn->shm->data, argc);
+	if ((ret = nvif_unpack(-ENOSYS, &data, &size, args->v0, 0, 0, true)))
+		return ret;
+
+	if (args->v0.type == NVIF_IOCTL_V0_NTFY_NEW) {
+		ntfy = data;
+		if ((ret = nvif_unpack(-ENOSYS, &data, &size, ntfy->v0, 0, 0, true)))
+			return ret;
+		req = data;
+		if ((ret = nvif_unpack(-ENOSYS, &data, &size, req->v0, 0, 0, true)))
+			return ret;
+		route = req->v0.route;
+		req->v0.route = conn->route;
+	}
+
+	ret = nvkm_ioctl(conn->client, super, conn->data, argc, &hack);
+	if (req)
+		req->v0.route = route;
+	memcpy(conn->shm->data, conn->data, argc);
+
+	/* The client deleted itself, and is no longer ours to clean up. */
+	if (ret == 1 && args->v0.type == NVIF_IOCTL_V0_DEL && !args->v0.object)
+		conn->client = NULL;
+	return ret;
+}
+
+static void
+nvos_ipc_conn_del(struct nvos_ipc_conn *conn)
+{
+	struct nvkm_object *object;
+
+	if (conn->client) {
+		/* The client went away without cleaning up after itself. */
+		object = &conn->client->object;
+		nvkm_object_fini(object, false);
+		nvkm_object_del(&object);
+	}
+
+	if (conn->ref)
+		nvos_client_fini(NULL);
+
+	mutex_lock(&nvos_ipc_mutex);
+	if (nvos_ipc_conn[conn->route] == conn)
+		nvos_ipc_conn[conn->route] = NULL;
+	mutex_unlock(&nvos_ipc_mutex);
+
+	if (conn->shm)
+		munmap(conn->shm, sizeof(*conn->shm));
+	if (conn->efd >= 0)
+		close(conn->efd);
+	close(conn->sock);
+	free(conn);
+}
+
+static int
+nvos_ipc_conn_init(struct nvos_ipc_conn *conn, struct nvos_ipc_msg *msg)
+{
+	char *name = NULL, *cfg = NULL, *dbg = NULL;
+	void *shm, *priv;
+	int fds[2], ret;
+
+	/* The first request carries the shared memory and notify eventfd. */
+	if ((ret = nvos_ipc_recv(conn->sock, msg, fds, 2)))
+		return ret;
+
+	if (msg->type != NVOS_IPC_INIT || fds[0] < 0 || fds[1] < 0) {
+		if (fds[0] >= 0)
+			close(fds[0]);
+		if (fds[1] >= 0)
+			close(fds[1]);
+		return -EPROTO;
+	}
+
+	conn->efd = fds[1];
+	shm = mmap(NULL, sizeof(*conn->shm), PROT_READ | PROT_WRITE,
+		   MAP_SHARED, fds[0], 0);
+	close(fds[0]);
+	if (shm == MAP_FAILED)
+		return -ENOMEM;
+	conn->shm = shm;
+
+	/* Don't trust the client to have terminated the strings. */
+	name = strndup(conn->shm->init.name, sizeof(conn->shm->init.name) - 1);
+	cfg  = strndup(conn->shm->init.cfg,  sizeof(conn->shm->init.cfg) - 1);
+	dbg  = strndup(conn->shm->init.dbg,  sizeof(conn->shm->init.dbg) - 1);
+	if (name && cfg && dbg) {
+		ret = nvos_client_init(name, msg->addr, cfg, dbg, &priv,
+				       nvos_ipc_ntfy);
+		conn->ref = true;
+		if (ret == 0)
+			conn->client = priv;
+	} else {
+		ret = -ENOMEM;
+	}
+
+	free(name);
+	free(cfg);
+	free(dbg);
+	return ret;
+}
+
+static void *
+nvos_ipc_conn_thread(void *arg)
+{
+	struct nvos_ipc_conn *conn = arg;
+	struct nvos_ipc_msg msg = {};
+	int fd, ret;
+
+	msg.ret = nvos_ipc_conn_init(conn, &msg);
+	if (nvos_ipc_send(conn->sock, &msg, NULL, 0) || msg.ret)
+		goto done;
+
+	while (!nvos_ipc_recv(conn->sock, &msg, NULL, 0)) {
+		fd = -1;
+
+		switch (msg.type) {
+		case NVOS_IPC_IOCTL:
+			msg.ret = nvos_ipc_conn_ioctl(conn, msg.addr, msg.size);
+			break;
+		case NVOS_IPC_MAP:
+			fd = nvos_ioremap_fd(msg.addr, msg.size, &msg.addr);
+			msg.ret = fd < 0 ? fd : 0;
+			break;
+		case NVOS_IPC_SUSPEND:
+			msg.ret = conn->client ?
+				  nvkm_object_fini(&conn->client->object, true) :
+				  -ENODEV;
+			break;
+		case NVOS_IPC_RESUME:
+			msg.ret = conn->client ?
+				  nvkm_object_init(&conn->client->object) :
+				  -ENODEV;
+			break;
+		default:
+			msg.ret = -EINVAL;
+			break;
+		}
+
+		ret = nvos_ipc_send(conn->sock, &msg, &fd, fd >= 0);
+		if (fd >= 0)
+			close(fd);
+		if (ret)
+			break;
+	}
+
+done:
+	nvos_ipc_conn_del(conn);
+	return NULL;
+}
+
+/* Accept clients until something goes wrong with the socket.  The socket
+ * grants whoever can connect to it the same access to the hardware as the
+ * daemon has, so it's created with the process' umask and nothing more.
+ */
+int
+nvos_ipc_serve(const char *path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	struct nvos_ipc_conn *conn;
+	pthread_t thread;
+	int sock, fd, ret, i;
+
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s",
+		 path ? path : nvos_ipc_path());
+
+	if ((sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) < 0)
+		return -errno;
+
+	unlink(addr.sun_path);
+	if (bind(sock, (void *)&addr, sizeof(addr)) || listen(sock, 16)) {
+		ret = -errno;
+		close(sock);
+		return ret;
+	}
+
+	while ((fd = accept4(sock, NULL, NULL, SOCK_CLOEXEC)) >= 0) {
+		if (!(conn = calloc(1, sizeof(*conn)))) {
+			close(fd);
+			continue;
+		}
+		conn->sock = fd;
+		conn->efd = -1;
+
+		/* Route 0 is NVIF_NOTIFY_V0_ROUTE_NVIF, never a connection. */
+		mutex_lock(&nvos_ipc_mutex);
+		for (i = 1; i < ARRAY_SIZE(nvos_ipc_conn); i++) {
+			if (!nvos_ipc_conn[i]) {
+				nvos_ipc_conn[i] = conn;
+				conn->route = i;
+				break;
+			}
+		}
+		mutex_unlock(&nvos_ipc_mutex);
+
+		if (!conn->route ||
+		    pthread_create(&thread, NULL, nvos_ipc_conn_thread, conn)) {
+			nvos_ipc_conn_del(conn);
+			continue;
+		}
+
+		pthread_detach(thread);
+	}
+
+	ret = -errno;
+	close(sock);
+	unlink(addr.sun_path);
+	return ret;
+}
+
+/******************************************************************************
+ * client
+ *****************************************************************************/
+struct nvos_ipc_client {
+	int sock;
+	int efd;
+	struct nvos_ipc_shm *shm;
+	pthread_mutex_t mutex; /* one request in flight at a time */
+	struct nvos_ring_reader event;
+	bool running;
+};
+
+static int
+nvos_ipc_call(struct nvos_ipc_client *ipc, struct nvos_ipc_msg *msg, int *fd)
+{
+	int ret = nvos_ipc_send(ipc->sock, msg, NULL, 0);
+	if (ret == 0)
+		ret = nvos_ipc_recv(ipc->sock, msg, fd, fd ? 1 : 0);
+	return ret ? ret : msg->ret;
+}
+
+static void
+nvos_ipc_client_unmap(void *priv, void __iomem *ptr, u32 size)
+{
+	const unsigned long align = (unsigned long)ptr & (getpagesize() - 1);
+	munmap((u8 *)ptr - align, size + align);
+}
+
+static void __iomem *
+nvos_ipc_client_map(void *priv, u64 handle, u32 size)
+{
+	struct nvos_ipc_client *ipc = priv;
+	struct nvos_ipc_msg msg = {
+		.type = NVOS_IPC_MAP,
+		.addr = handle,
+		.size = size,
+	};
+	u8 *ptr = NULL;
+	u64 align;
+	int fd;
+
+	pthread_mutex_lock(&ipc->mutex);
+	if (!nvos_ipc_call(ipc, &msg, &fd) && fd >= 0) {
+		align = msg.addr & (getpagesize() - 1);
+		ptr = mmap(NULL, size + align, PROT_READ | PROT_WRITE,
+			   MAP_SHARED, fd, msg.addr - align);
+		ptr = ptr != MAP_FAILED ? ptr + align : NULL;
+	}
+	pthread_mutex_unlock(&ipc->mutex);
+
+	if (fd >= 0)
+		close(fd);
+	return ptr;
+}
+
+static int
+nvos_ipc_client_ioctl(void *priv, bool super, void *data, u32 size,
+		      void **hack)
+{
+	struct nvos_ipc_client *ipc = priv;
+	struct nvos_ipc_msg msg = {
+		.type = NVOS_IPC_IOCTL,
+		.addr = super,
+		.size = size,
+	};
+	int ret;
+
+	if (size > sizeof(ipc->shm->data))
+		return -E2BIG;
+
+	pthread_mutex_lock(&ipc->mutex);
+	memcpy(ipc->shm->data, data, size);
+	ret = nvos_ipc_call(ipc, &msg, NULL);
+	memcpy(data, ipc->shm->data, size);
+	pthread_mutex_unlock(&ipc->mutex);
+	return ret;
+}
+
+static int
+nvos_ipc_client_request(void *priv, enum nvos_ipc_type type)
+{
+	struct nvos_ipc_client *ipc = priv;
+	struct nvos_ipc_msg msg = { .type = type };
+	int ret;
+
+	pthread_mutex_lock(&ipc->mutex);
+	ret = nvos_ipc_call(ipc, &msg, NULL);
+	pthread_mutex_unlock(&ipc->mutex);
+	return ret;
+}
+
+static int
+nvos_ipc_client_resume(void *priv)
+{
+	return nvos_ipc_client_request(priv, NVOS_IPC_RESUME);
+}
+
+static int
+nvos_ipc_client_suspend(void *priv)
+{
+	return nvos_ipc_client_request(priv, NVOS_IPC_SUSPEND);
+}
+
+static void
+nvos_ipc_client_ntfy_del(void *priv, u64 token)
+{
+	struct nvos_ipc_client *ipc = priv;
+	if (ipc->running)
+		nvos_ring_reader_drop(&ipc->event, token);
+}
+
+static void
+nvos_ipc_client_fini(void *priv)
+{
+	struct nvos_ipc_client *ipc = priv;
+	if (ipc) {
+		if (ipc->running)
+			nvos_ring_reader_fini(&ipc->event);
+		if (ipc->sock >= 0)
+			close(ipc->sock);
+		if (ipc->efd >= 0)
+			close(ipc->efd);
+		if (ipc->shm)
+			munmap(ipc->shm, sizeof(*ipc->shm));
+		free(ipc);
+	}
+}
+
+static int
+nvos_ipc_client_init(const char *name, u64 device, const char *cfg,
+		     const char *dbg, void **ppriv)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	struct nvos_ipc_msg msg = {
+		.type = NVOS_IPC_INIT,
+		.addr = device,
+	};
+	struct nvos_ipc_client *ipc;
+	void *shm;
+	int fds[2], ret;
+
+	if (!(ipc = *ppriv = calloc(1, sizeof(*ipc))))
+		return -ENOMEM;
+	ipc->sock = -1;
+	ipc->efd = -1;
+	pthread_mutex_init(&ipc->mutex, NULL);
+
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", nvos_ipc_path());
+	if ((ipc->sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0)) < 0 ||
+	    connect(ipc->sock, (void *)&addr, sizeof(addr)))
+		return -errno;
+
+	if ((ipc->efd = eventfd(0, EFD_CLOEXEC)) < 0 ||
+	    (fds[0] = memfd_create("nvkm-ipc", MFD_CLOEXEC)) < 0)
+		return -errno;
+
+	if (ftruncate(fds[0], sizeof(*ipc->shm)) ||
+	    (shm = mmap(NULL, sizeof(*ipc->shm), PROT_READ | PROT_WRITE,
+			MAP_SHARED, fds[0], 0)) == MAP_FAILED) {
+		ret = -errno;
+		close(fds[0]);
+		return ret;
+	}
+	ipc->shm = shm;
+
+	snprintf(ipc->shm->init.name, sizeof(ipc->shm->init.name), "%s", name);
+	snprintf(ipc->shm->init.cfg, sizeof(ipc->shm->init.cfg), "%s",
+		 cfg ? cfg : "");
+	snprintf(ipc->shm->init.dbg, sizeof(ipc->shm->init.dbg), "%s",
+		 dbg ? dbg : "");
+
+	fds[1] = ipc->efd;
+	ret = nvos_ipc_send(ipc->sock, &msg, fds, 2);
+	close(fds[0]);
+	if (ret == 0)
+		ret = nvos_ipc_recv(ipc->sock, &msg, NULL, 0);
+	if (ret || (ret = msg.ret))
+		return ret;
+
+	if ((ret = nvos_ring_reader_init(&ipc->event, &ipc->shm->ntfy,
+					 ipc->efd)))
+		return ret;
+	ipc->running = true;
+	return 0;
+}
+
+const struct nvif_driver
+nvif_driver_ipc = {
+	.name = "ipc",
+	.init = nvos_ipc_client_init,
+	.fini = nvos_ipc_client_fini,
+	.suspend = nvos_ipc_client_suspend,
+	.resume = nvos_ipc_client_resume,
+	.ioctl = nvos_ipc_client_ioctl,
+	.map = nvos_ipc_client_map,
+	.unmap = nvos_ipc_client_unmap,
+	.ntfy_del = nvos_ipc_client_ntfy_del,
+	.keep = true,
+	.automap = 16,
+};
@@ -130,6 +130,37 @@ nvos_iounmap(void __iomem *ptr)
 	mutex_unlock(&os_ioremap_mutex);
 }
 
+/* Open the sysfs resource file backing a BAR address, so that a mapping
+ * of it can be handed to another process.  On success, *offset is set
+ * to the position of addr within the file.
+ */
+int
+nvos_ioremap_fd(u64 addr, u64 size, u64 *offset)
+{
+	struct os_device *odev;
+	char path[128];
+	int i, fd;
+
+	list_for_each_entry(odev, &os_device_list, head) {
+		struct pci_device *pdev = odev->pdev.pdev;
+		for (i = 0; i < ARRAY_SIZE(pdev->regions); i++) {
+			if (addr        >= pdev->regions[i].base_addr &&
+			    addr + size <= pdev->regions[i].base_addr +
+					   pdev->regions[i].size) {
+				snprintf(path, sizeof(path),
+					 "/sys/bus/pci/devices/%s/resource%d",
+					 odev->pdev.dev.name, i);
+				if ((fd = open(path, O_RDWR | O_CLOEXEC)) < 0)
+					return -errno;
+				*offset = addr - pdev->regions[i].base_addr;
+				return fd;
+			}
+		}
+	}
+
+	return -EINVAL;
+}
+
 /******************************************************************************
  * client interfaces
  *****************************************************************************/
@@ -256,8 +287,8 @@ os_client_suspend(void *priv)
 	return nvkm_object_fini(&client->object, true);
 }
 
-static void
-os_client_fini(void *priv)
+void
+nvos_client_fini(void *priv)
 {
 	mutex_lock(&os_mutex);
 	if (--os_client_nr == 0)
@@ -265,9 +296,10 @@ os_client_fini(void *priv)
 	mutex_unlock(&os_mutex);
 }
 
-static int
-os_client_init(const char *name, u64 device, const char *cfg,
-	       const char *dbg, void **ppriv)
+int
+nvos_client_init(const char *name, u64 device, const char *cfg,
+		 const char *dbg, void **ppriv,
+		 int (*ntfy)(const void *, u32, const void *, u32))
 {
 	struct nvkm_client *client;
 	int ret;
@@ -277,20 +309,70 @@ os_client_init(const char *name, u64 device, const char *cfg,
 		os_init(cfg, dbg);
 	mutex_unlock(&os_mutex);
 
-	ret = nvkm_client_new(name, device, cfg, dbg, nvif_notify, &client);
+	ret = nvkm_client_new(name, device, cfg, dbg, ntfy, &client);
 	*ppriv = client;
 	return ret;
 }
 
+static int
+os_client_init(const char *name, u64 device, const char *cfg,
+	       const char *dbg, void **ppriv)
+{
+	return nvos_client_init(name, device, cfg, dbg, ppriv, nvif_notify);
+}
+
+static void
+os_client_fini_ring(void *priv)
+{
+	nvos_client_fini(priv);
+	nvos_ring_fini();
+}
+
+static void
+os_client_ntfy_del_ring(void *priv, u64 token)
+{
+	nvos_ring_drop(token);
+}
+
+static int
+os_client_init_ring(const char *name, u64 device, const char *cfg,
+		    const char *dbg, void **ppriv)
+{
+	int ret = nvos_ring_init();
+	if (ret)
+		return ret;
+	return nvos_client_init(name, device, cfg, dbg, ppriv, nvos_ring_ntfy);
+}
+
 const struct nvif_driver
 nvif_driver_lib = {
 	.name = "lib",
 	.init = os_client_init,
-	.fini = os_client_fini,
+	.fini = nvos_client_fini,
 	.suspend = os_client_suspend,
 	.resume = os_client_resume,
 	.ioctl = os_client_ioctl,
 	.map = os_client_map,
 	.unmap = os_client_unmap,
 	.keep = false,
+	.automap = 16,
+};
+
+/* As "lib", but with notifications delivered asynchronously through
+ * the notify ring, which re-arms them from the consumer the same way
+ * the drm backend does.
+ */
+const struct nvif_driver
+nvif_driver_lib_ring = {
+	.name = "lib-ring",
+	.init = os_client_init_ring,
+	.fini = os_client_fini_ring,
+	.suspend = os_client_suspend,
+	.resume = os_client_resume,
+	.ioctl = os_client_ioctl,
+	.map = os_client_map,
+	.unmap = os_client_unmap,
+	.ntfy_del = os_client_ntfy_del_ring,
+	.keep = true,
+	.automap = 16,
 };
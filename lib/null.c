@@ -34,15 +34,22 @@
 
 #include "priv.h"
 
+/* There's no hardware behind the null device, so BAR0 is backed by plain
+ * memory, which lets objects on it be read, written and mapped.
+ */
+#define NULL_BAR0_SIZE 0x01000000
+
 static DEFINE_MUTEX(null_mutex);
 static int null_client_nr = 0;
 static struct nvkm_device *null_device;
+static u8 *null_bar0;
 static struct pci_dev
 null_pci_dev = {
 	.dev = {
 		.name = "0000:00:00.0",
 	},
 	.pdev = &(struct pci_device) {
+		.regions[0].size = NULL_BAR0_SIZE,
 	},
 	.bus = &null_pci_dev._bus,
 };
@@ -51,16 +58,27 @@ static void
 null_fini(void)
 {
 	nvkm_device_del(&null_device);
+	free(null_bar0);
+	null_bar0 = NULL;
 }
 
 static void
 null_init(const char *cfg, const char *dbg, bool init)
 {
-	int ret = nvkm_device_pci_new(&null_pci_dev, cfg, dbg, os_device_detect,
-				      os_device_mmio, os_device_subdev,
-				      &null_device);
-	if (ret)
+	int ret;
+
+	if (!(null_bar0 = calloc(1, NULL_BAR0_SIZE)))
+		return;
+
+	ret = nvkm_device_pci_new(&null_pci_dev, cfg, dbg, os_device_detect,
+				  false, os_device_subdev, &null_device);
+	if (ret) {
 		null_fini();
+		return;
+	}
+
+	if (os_device_mmio)
+		null_device->pri = null_bar0;
 }
 
 static void
@@ -71,7 +89,9 @@ null_client_unmap(void *priv, void *ptr, u32 size)
 static void *
 null_client_map(void *priv, u64 handle, u32 size)
 {
-	return NULL;
+	if (!null_bar0 || handle + size > NULL_BAR0_SIZE)
+		return NULL;
+	return null_bar0 + handle;
 }
 
 static int
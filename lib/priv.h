@@ -2,6 +2,7 @@
 #define __OS_PRIV_H__
 
 #include <core/device.h>
+#include <nvif/event.h>
 
 #include <pthread.h>
 #include <unistd.h>
@@ -14,6 +15,67 @@ struct os_device {
 	struct pci_dev pdev;
 };
 
+/* Notifications are appended to a fixed-size ring from whatever context
+ * nvkm sends them in, and delivered to nvif_notify() in batches by a
+ * consumer that sleeps on an eventfd.  The ring itself holds no pointers,
+ * so it may be placed in memory shared with another process.
+ */
+#define NVOS_RING_SIZE 1024 /* records, must be a power of two */
+#define NVOS_RING_DATA 64   /* largest reply carried in a record */
+
+struct nvos_ring_buf {
+	u32 head; /* next sequence number to be written */
+	u32 tail; /* next sequence number to be delivered */
+	struct nvos_ring_rec {
+		u32 seq;
+		u32 size;
+		struct nvif_notify_rep_v0 rep;
+		u8 data[NVOS_RING_DATA];
+	} rec[NVOS_RING_SIZE];
+};
+
+int  nvos_ring_push(struct nvos_ring_buf *, int fd,
+		    const void *, u32, const void *, u32);
+
+/* The consumer thread delivers each batch under 'lock', so that records
+ * for a notify that is being deleted can be dropped, and any delivery to
+ * it waited for.  It's stopped by setting 'stop' and signalling 'fd'.
+ */
+struct nvos_ring_reader {
+	struct nvos_ring_buf *buf;
+	int fd;
+	pthread_mutex_t lock;
+	pthread_t thread;
+	bool stop;
+	u64 batches;
+};
+
+int  nvos_ring_reader_init(struct nvos_ring_reader *,
+			   struct nvos_ring_buf *, int fd);
+void nvos_ring_reader_fini(struct nvos_ring_reader *);
+void nvos_ring_reader_drop(struct nvos_ring_reader *, u64 token);
+
+struct nvos_ring_stat {
+	u64 events;  /* notifications queued */
+	u64 dropped; /* notifications lost to a full ring */
+	u64 wakeups; /* eventfd signals */
+	u64 batches; /* consumer passes over the ring */
+};
+
+int  nvos_ring_init(void);
+void nvos_ring_fini(void);
+int  nvos_ring_ntfy(const void *, u32, const void *, u32);
+void nvos_ring_drop(u64 token);
+void nvos_ring_stat(struct nvos_ring_stat *);
+
+int  nvos_client_init(const char *name, u64 device, const char *cfg,
+		      const char *dbg, void **ppriv,
+		      int (*ntfy)(const void *, u32, const void *, u32));
+void nvos_client_fini(void *priv);
+int  nvos_ioremap_fd(u64 addr, u64 size, u64 *offset);
+
+int  nvos_ipc_serve(const char *path);
+
 extern bool os_device_detect;
 extern bool os_device_mmio;
 extern u64  os_device_subdev;
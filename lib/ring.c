@@ -0,0 +1,259 @@
+/*
+ * Copyright 2020 Red Hat Inc.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE COPYRIGHT HOLDER(S) OR AUTHOR(S) BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include "priv.h"
+
+#include <sys/eventfd.h>
+
+#include <nvif/notify.h>
+#include <nvif/event.h>
+
+/* The ring is only signalled when a record lands in an empty ring, so a
+ * burst of events costs one wakeup rather than one per event.
+ */
+static struct nvos_ring {
+	pthread_mutex_t lock; /* serialises producers */
+	struct nvos_ring_buf buf;
+
+	pthread_mutex_t mutex; /* serialises init/fini */
+	int refs;
+	struct nvos_ring_reader reader;
+
+	struct nvos_ring_stat stat;
+} nvos_ring = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.mutex = PTHREAD_MUTEX_INITIALIZER,
+	.reader.fd = -1,
+};
+
+/* Producers must be serialised by the caller.  Returns -ENOSPC if the
+ * ring is full, 1 if the consumer was woken, and 0 otherwise.
+ */
+int
+nvos_ring_push(struct nvos_ring_buf *ring, int fd, const void *header,
+	       u32 length, const void *data, u32 size)
+{
+	struct nvos_ring_rec *rec;
+	u32 head, tail;
+
+	if (length != sizeof(rec->rep) || size > sizeof(rec->data)) {
+		WARN_ON(1);
+		return -EINVAL;
+	}
+
+	head = ring->head;
+	tail = __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST);
+	if (head - tail >= NVOS_RING_SIZE)
+		return -ENOSPC;
+
+	rec = &ring->rec[head & (NVOS_RING_SIZE - 1)];
+	rec->seq = head;
+	rec->size = size;
+	memcpy(&rec->rep, header, length);
+	memcpy(rec->data, data, size);
+	__atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+
+	if (head == tail) {
+		const u64 one = 1;
+		if (write(fd, &one, sizeof(one)) != sizeof(one))
+			WARN_ON(1);
+		return 1;
+	}
+
+	return 0;
+}
+
+/* Deliver everything queued so far, from the ring's single consumer. */
+static void
+nvos_ring_pull(struct nvos_ring_buf *ring)
+{
+	struct nvos_ring_rec *rec;
+	u32 tail = ring->tail;
+
+	while (tail != __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST)) {
+		rec = &ring->rec[tail & (NVOS_RING_SIZE - 1)];
+		WARN_ON(rec->seq != tail);
+		if (rec->rep.token)
+			nvif_notify(&rec->rep, sizeof(rec->rep),
+				    rec->data, rec->size);
+		__atomic_store_n(&ring->tail, ++tail, __ATOMIC_SEQ_CST);
+	}
+}
+
+static void *
+nvos_ring_reader_thread(void *arg)
+{
+	struct nvos_ring_reader *reader = arg;
+	u64 count;
+
+	while (read(reader->fd, &count, sizeof(count)) == sizeof(count)) {
+		if (__atomic_load_n(&reader->stop, __ATOMIC_SEQ_CST))
+			break;
+
+		pthread_mutex_lock(&reader->lock);
+		nvos_ring_pull(reader->buf);
+		reader->batches++;
+		pthread_mutex_unlock(&reader->lock);
+	}
+
+	return NULL;
+}
+
+/* Forget any records still queued for a notify that has been deleted.
+ * Nothing new can be queued for it by then, and holding the lock waits
+ * out a delivery that may already be in progress.
+ */
+void
+nvos_ring_reader_drop(struct nvos_ring_reader *reader, u64 token)
+{
+	struct nvos_ring_buf *ring = reader->buf;
+	struct nvos_ring_rec *rec;
+	u32 tail;
+
+	pthread_mutex_lock(&reader->lock);
+	for (tail = ring->tail;
+	     tail != __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST); tail++) {
+		rec = &ring->rec[tail & (NVOS_RING_SIZE - 1)];
+		if (rec->rep.token == token)
+			rec->rep.token = 0;
+	}
+	pthread_mutex_unlock(&reader->lock);
+}
+
+/* Anything still queued is discarded, the notifies are gone by now. */
+void
+nvos_ring_reader_fini(struct nvos_ring_reader *reader)
+{
+	const u64 one = 1;
+
+	__atomic_store_n(&reader->stop, true, __ATOMIC_SEQ_CST);
+	if (write(reader->fd, &one, sizeof(one)) != sizeof(one))
+		WARN_ON(1);
+	pthread_join(reader->thread, NULL);
+	pthread_mutex_destroy(&reader->lock);
+}
+
+int
+nvos_ring_reader_init(struct nvos_ring_reader *reader,
+		      struct nvos_ring_buf *buf, int fd)
+{
+	pthread_mutexattr_t attr;
+	int ret;
+
+	reader->buf = buf;
+	reader->fd = fd;
+	reader->stop = false;
+	reader->batches = 0;
+
+	/* A notify may be deleted from within its own callback. */
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&reader->lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	ret = -pthread_create(&reader->thread, NULL,
+			      nvos_ring_reader_thread, reader);
+	if (ret)
+		pthread_mutex_destroy(&reader->lock);
+	return ret;
+}
+
+int
+nvos_ring_ntfy(const void *header, u32 length, const void *data, u32 size)
+{
+	struct nvos_ring *ring = &nvos_ring;
+	int ret;
+
+	pthread_mutex_lock(&ring->lock);
+	ret = nvos_ring_push(&ring->buf, ring->reader.fd, header, length,
+			     data, size);
+	if (ret < 0) {
+		/* Leave the notify armed, the next event will get through. */
+		if (ret == -ENOSPC)
+			ring->stat.dropped++;
+		pthread_mutex_unlock(&ring->lock);
+		return NVIF_NOTIFY_KEEP;
+	}
+
+	ring->stat.events++;
+	ring->stat.wakeups += ret;
+	pthread_mutex_unlock(&ring->lock);
+
+	/* The consumer re-arms the notify once it has been delivered. */
+	return NVIF_NOTIFY_DROP;
+}
+
+void
+nvos_ring_drop(u64 token)
+{
+	nvos_ring_reader_drop(&nvos_ring.reader, token);
+}
+
+void
+nvos_ring_stat(struct nvos_ring_stat *stat)
+{
+	pthread_mutex_lock(&nvos_ring.lock);
+	*stat = nvos_ring.stat;
+	stat->batches = nvos_ring.reader.batches;
+	pthread_mutex_unlock(&nvos_ring.lock);
+}
+
+/* The consumer may call back into nvkm, which can queue more events and
+ * take ring->lock, so it's stopped without holding that.
+ */
+void
+nvos_ring_fini(void)
+{
+	struct nvos_ring *ring = &nvos_ring;
+
+	pthread_mutex_lock(&ring->mutex);
+	if (--ring->refs == 0) {
+		nvos_ring_reader_fini(&ring->reader);
+		close(ring->reader.fd);
+		ring->reader.fd = -1;
+	}
+	pthread_mutex_unlock(&ring->mutex);
+}
+
+int
+nvos_ring_init(void)
+{
+	struct nvos_ring *ring = &nvos_ring;
+	int ret = 0, fd;
+
+	pthread_mutex_lock(&ring->mutex);
+	if (ring->refs++ == 0) {
+		ring->buf.head = ring->buf.tail = 0;
+		if ((fd = eventfd(0, EFD_CLOEXEC)) < 0) {
+			ret = -errno;
+		} else
+		if ((ret = nvos_ring_reader_init(&ring->reader,
+						 &ring->buf, fd))) {
+			ring->reader.fd = -1;
+			close(fd);
+		}
+
+		if (ret)
+			ring->refs--;
+	}
+	pthread_mutex_unlock(&ring->mutex);
+	return ret;
+}